@@ -6,67 +6,127 @@
 
 #include <alsa/asoundlib.h>
 #include "kissfft/kiss_fft.h"
+#include "kissfft/kiss_fftr.h"
+#include "dsp.h"
+#include "audio_led.h"
+#include "effects.h"
+#include "canvas.h"
+#include "render_pool.h"
+#include "frame_queue.h"
+#include "governor.h"
+#include "scaler.h"
+#include "transition.h"
+#include "http_server.h"
+#include "preview.h"
+#include "metrics.h"
+#include "trace.h"
 
 #include <cmath>
 #include <cstdlib>
 #include <cstdint>
 #include <cerrno>
 #include <cstring>
+#include <cstdio>
 #include <thread>
 #include <atomic>
 #include <chrono>
-#include <mutex>
+#include <algorithm>
+#include <functional>
+#include <vector>
 #include <iostream>
 #include <sstream>
-#include <tuple>
-#include <sys/socket.h>
-#include <netinet/in.h>
 #include <unistd.h>
 
-#include "led-matrix.h"
+#ifndef HEADLESS
+#include "matrix_canvas.h"
 using namespace rgb_matrix;
+#endif
 
-// ====================================================================
-// SETTINGS (adjustable via web)
-// ====================================================================
-static const int WIDTH  = 128;
-static const int HEIGHT = 64;
-
-struct Settings {
-    std::atomic<int> effectDuration{5};      // seconds per effect
-    std::atomic<int> brightness{180};         // 0-255
-    std::atomic<float> noiseThreshold{0.1f}; // volume threshold
-    std::atomic<int> currentEffect{-1};       // -1 = auto, 0-10 = manual
-    std::atomic<float> sensitivity{4.0f};     // audio sensitivity multiplier (lower for line-in)
-    std::atomic<bool> autoLoop{true};         // true = cycle through effects
-    std::atomic<int> modeSpeed{4};            // seconds between Volume Bars mode changes
-    std::atomic<int> animSpeed{100};          // animation speed percentage (10-200%)
-};
-
-Settings settings;
+static bool g_preferMmapCapture = true;  // --capture=rw forces the old read() mode
 
 // ====================================================================
-// GLOBAL TIMING
+// AUDIO THREAD (ALSA + FFT + BEAT DETECTION)
 // ====================================================================
-static std::atomic<float> g_deltaTime{0.016f};     // Time since last frame (with speed multiplier)
-static std::atomic<float> g_rawDeltaTime{0.016f};  // Raw time since last frame (for timers)
+// Fixed-point build (make FIXED_POINT=1): the FFT runs in Q15 on the raw
+// S16 samples and scales its output by 1/N. One output LSB therefore equals
+// N/32768 in the units of the float path.
+//
+// Tolerance vs. the float build: band values stay within ~4% (magnitude
+// approximation in dsp_magnitude_q15) plus about one LSB of rounding noise per bin,
+// i.e. |delta| <= 0.04*v + (N/32768) * bandGain * sensitivity. At the default
+// sensitivity the LSB term ranges from 0.04 (band 0) to 0.75 (band 7),
+// which is under one pixel of spectrum bar height. Very quiet treble
+// reads slightly low because the per-stage rounding truncates it first.
+
+// ---------------------- Capture setup ----------------------------
+// Low-latency mode: small explicit periods and mmap access, so the
+// analysis reads samples straight out of the driver's ring buffer.
+static const snd_pcm_uframes_t CAPTURE_PERIOD  = 128;  // ~2.9 ms at 44.1 kHz
+static const snd_pcm_uframes_t CAPTURE_PERIODS = 4;    // buffer = ~11.6 ms
+
+static int setupMmapCapture(snd_pcm_t* handle) {
+    snd_pcm_hw_params_t* hw;
+    snd_pcm_hw_params_alloca(&hw);
+    int err;
 
-// ====================================================================
-// SHARED AUDIO STATE
-// ====================================================================
-struct AudioState {
-    std::atomic<float> volume {0};
-    std::atomic<float> beat {0};
-    float spectrum[8] = {0};
-    std::mutex specMutex;
-};
+    if ((err = snd_pcm_hw_params_any(handle, hw)) < 0) return err;
+    if ((err = snd_pcm_hw_params_set_rate_resample(handle, hw, 1)) < 0) return err;
+    if ((err = snd_pcm_hw_params_set_access(handle, hw, SND_PCM_ACCESS_MMAP_INTERLEAVED)) < 0) return err;
+    if ((err = snd_pcm_hw_params_set_format(handle, hw, SND_PCM_FORMAT_S16_LE)) < 0) return err;
+    if ((err = snd_pcm_hw_params_set_channels(handle, hw, 1)) < 0) return err;
+
+    unsigned int rate = 44100;
+    if ((err = snd_pcm_hw_params_set_rate_near(handle, hw, &rate, 0)) < 0) return err;
+    snd_pcm_uframes_t period = CAPTURE_PERIOD;
+    if ((err = snd_pcm_hw_params_set_period_size_near(handle, hw, &period, 0)) < 0) return err;
+    snd_pcm_uframes_t bufferSize = period * CAPTURE_PERIODS;
+    if ((err = snd_pcm_hw_params_set_buffer_size_near(handle, hw, &bufferSize)) < 0) return err;
+    if ((err = snd_pcm_hw_params(handle, hw)) < 0) return err;
+
+    // Read back what the driver actually granted
+    snd_pcm_hw_params_get_rate(hw, &rate, 0);
+    snd_pcm_hw_params_get_period_size(hw, &period, 0);
+    snd_pcm_hw_params_get_buffer_size(hw, &bufferSize);
+
+    // Wake up once per period
+    snd_pcm_sw_params_t* sw;
+    snd_pcm_sw_params_alloca(&sw);
+    if ((err = snd_pcm_sw_params_current(handle, sw)) < 0) return err;
+    if ((err = snd_pcm_sw_params_set_avail_min(handle, sw, period)) < 0) return err;
+    if ((err = snd_pcm_sw_params(handle, sw)) < 0) return err;
+
+    capture.rate.store(rate);
+    capture.period.store((int)period);
+    capture.bufferSize.store((int)bufferSize);
+    return 0;
+}
 
-AudioState audio;
+// Shared xrun/error recovery for both capture modes
+static void recoverCapture(snd_pcm_t* handle, int err) {
+    if (err == -EPIPE) {
+        // Overrun - need to prepare and restart
+        metrics.captureRecoveries[RECOVER_OVERRUN].inc();
+        snd_pcm_prepare(handle);
+        snd_pcm_start(handle);
+    } else if (err == -EIO) {
+        // I/O error - try full recovery
+        metrics.captureRecoveries[RECOVER_IO].inc();
+        snd_pcm_drop(handle);
+        snd_pcm_prepare(handle);
+        snd_pcm_start(handle);
+    } else {
+        metrics.captureRecoveries[RECOVER_OTHER].inc();
+        snd_pcm_recover(handle, err, 0);
+    }
+}
+
+static int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
-// ====================================================================
-// AUDIO THREAD (ALSA + FFT + BEAT DETECTION)
-// ====================================================================
 void audioThread() {
+    TRACE_THREAD("audio");
 
     snd_pcm_t* handle;
     int err;
@@ -95,31 +155,59 @@ void audioThread() {
         return;
     }
 
-    err = snd_pcm_set_params(handle,
-        SND_PCM_FORMAT_S16_LE,          // Format: 16-bit
-        SND_PCM_ACCESS_RW_INTERLEAVED,  // Interleaved
-        1,                              // Channels: 1 (Mono)
-        44100,                          // Sample Rate
-        1,                              // Allow resampling: yes
-        500000);                        // Latency: 500ms
-    if (err < 0) {
-        std::cerr << "Set params error: " << snd_strerror(err) << "\n";
-        // Try with different sample rate
+    bool useMmap = false;
+    if (g_preferMmapCapture) {
+        err = setupMmapCapture(handle);
+        if (err < 0) {
+            std::cerr << "Low-latency mmap capture unavailable (" << snd_strerror(err)
+                      << "), falling back to read mode\n";
+        } else {
+            useMmap = true;
+        }
+    }
+
+    if (!useMmap) {
         err = snd_pcm_set_params(handle,
-            SND_PCM_FORMAT_S16_LE,
-            SND_PCM_ACCESS_RW_INTERLEAVED,
-            1,
-            48000,                      // Try 48kHz
-            1,
-            500000);
+            SND_PCM_FORMAT_S16_LE,          // Format: 16-bit
+            SND_PCM_ACCESS_RW_INTERLEAVED,  // Interleaved
+            1,                              // Channels: 1 (Mono)
+            44100,                          // Sample Rate
+            1,                              // Allow resampling: yes
+            500000);                        // Latency: 500ms
         if (err < 0) {
-            std::cerr << "Set params error (48kHz): " << snd_strerror(err) << "\n";
-            return;
+            std::cerr << "Set params error: " << snd_strerror(err) << "\n";
+            // Try with different sample rate
+            err = snd_pcm_set_params(handle,
+                SND_PCM_FORMAT_S16_LE,
+                SND_PCM_ACCESS_RW_INTERLEAVED,
+                1,
+                48000,                      // Try 48kHz
+                1,
+                500000);
+            if (err < 0) {
+                std::cerr << "Set params error (48kHz): " << snd_strerror(err) << "\n";
+                return;
+            }
+            capture.rate.store(48000);
+            std::cerr << "Using 48kHz sample rate\n";
+        } else {
+            capture.rate.store(44100);
+            std::cerr << "Using 44.1kHz sample rate\n";
         }
-        std::cerr << "Using 48kHz sample rate\n";
-    } else {
-        std::cerr << "Using 44.1kHz sample rate\n";
+        snd_pcm_uframes_t bufferSize = 0, period = 0;
+        snd_pcm_get_params(handle, &bufferSize, &period);
+        capture.period.store((int)period);
+        capture.bufferSize.store((int)bufferSize);
     }
+    capture.mmap.store(useMmap);
+
+    const int sampleRate = capture.rate.load();
+    std::cerr << "Capture: " << (useMmap ? "mmap" : "read")
+              << ", rate " << sampleRate
+              << " Hz, period " << capture.period.load() << " frames ("
+              << capture.period.load() * 1000.0f / sampleRate << " ms), buffer "
+              << capture.bufferSize.load() << " frames ("
+              << capture.bufferSize.load() * 1000.0f / sampleRate << " ms)\n";
 
     err = snd_pcm_prepare(handle);
     if (err < 0) {
@@ -134,1097 +222,205 @@ void audioThread() {
     }
     std::cerr << "PCM started successfully\n";
 
-    const int N = 1024;
-    int16_t buffer[N];  // 16-bit signed for S16_LE format
-    float samples[N];   // normalized float samples
-
-    kiss_fft_cfg cfg = kiss_fft_alloc(N, 0, NULL, NULL);
-    kiss_fft_cpx in[N], out[N];
+    // Overlapping STFT: samples are pushed into a sliding window as they
+    // arrive and the FFT runs on the newest N samples once per hop.
+    const int N = FFT_SIZE;
+    int16_t buffer[N];                 // 16-bit signed for S16_LE format (read mode only)
+    SlidingWindow window(N);           // newest N samples + analysis window
+    kiss_fft_scalar frame[N];          // windowed FFT input
+
+    // Real-input FFT: N samples in, N/2+1 bins out (only bins <= Nyquist are used)
+    kiss_fftr_cfg cfg = kiss_fftr_alloc(N, 0, NULL, NULL);
+    kiss_fft_cpx out[N/2 + 1];
+
+    // 8-band spectrum with logarithmic frequency bands
+    // With 44.1kHz and N=1024: each bin = ~43Hz
+    // Band boundaries designed for musical perception:
+    // Band 0: Sub-bass     20-60 Hz    (bins 1-2)
+    // Band 1: Bass         60-150 Hz   (bins 2-4)
+    // Band 2: Low-mid      150-400 Hz  (bins 4-10)
+    // Band 3: Mid          400-1kHz    (bins 10-24)
+    // Band 4: Upper-mid    1-2.5kHz    (bins 24-58)
+    // Band 5: Presence     2.5-5kHz    (bins 58-116)
+    // Band 6: Brilliance   5-10kHz     (bins 116-232)
+    // Band 7: Air          10-20kHz    (bins 232-465)
+    const int bandStart[8] = {1,   2,   4,   10,  24,  58,  116, 232};
+    const int bandEnd[8]   = {2,   4,   10,  24,  58,  116, 232, 465};
+
+    // Per-band gain compensation (bass naturally has more energy)
+    // Lower values = reduce gain, higher values = boost gain
+    const float bandGain[8] = {0.3f, 0.5f, 0.8f, 1.0f, 1.5f, 2.5f, 4.0f, 6.0f};
+
+    // Magnitudes are computed once for every bin any band uses
+    const int magBins = bandEnd[7] < N/2 ? bandEnd[7] : N/2;
+#ifdef FIXED_POINT
+    int32_t mag[N/2];
+#else
+    float mag[N/2];
+#endif
+    std::cerr << "DSP kernels: " << dsp_variant() << "\n";
 
     float last_energy = 0;
     float beat_smooth = 0;
 
+    // Beat detector constants were tuned for one update per N samples;
+    // rescaled per hop so time constants stay the same at any hop size.
+    int hop = 0;
+    float avgKeep = 0.95f;
+    float beatDecay = 0.92f;
+
     std::cerr << "Audio capture started" << std::endl;
     int frameCount = 0;
+    int pending = 0;  // samples captured since the last analysis
+    int64_t captureNs = 0;  // when the newest samples were taken from ALSA
     while (true) {
-        frameCount++;
+        int newHop = settings.hopSize.load();
+        if (newHop < 64) newHop = 64;
+        if (newHop > N) newHop = N;
+        if (newHop != hop) {
+            hop = newHop;
+            avgKeep = powf(0.95f, (float)hop / N);
+            beatDecay = powf(0.92f, (float)hop / N);
+        }
+        window.setWindow(settings.window.load());
+
         // capture
-        int frames = snd_pcm_readi(handle, buffer, N);
-
-        if (frames < 0) {
-            if (frames == -EPIPE) {
-                // Overrun - need to prepare and restart
-                snd_pcm_prepare(handle);
-                snd_pcm_start(handle);
-            } else if (frames == -EIO) {
-                // I/O error - try full recovery
-                snd_pcm_drop(handle);
-                snd_pcm_prepare(handle);
-                snd_pcm_start(handle);
-            } else {
-                snd_pcm_recover(handle, frames, 0);
+        if (useMmap) {
+            // Sleep until at least one period is ready, then consume
+            // everything available directly from the DMA ring buffer
+            {
+                TRACE_SCOPE("audio_wait");
+                err = snd_pcm_wait(handle, 1000);
+            }
+            snd_pcm_sframes_t avail = err < 0 ? err : snd_pcm_avail_update(handle);
+            if (avail < 0) {
+                recoverCapture(handle, (int)avail);
+                continue;
+            }
+            {
+                TRACE_SCOPE("audio_read");
+                while (avail > 0) {
+                    const snd_pcm_channel_area_t* areas;
+                    snd_pcm_uframes_t offset, frames = avail;
+                    err = snd_pcm_mmap_begin(handle, &areas, &offset, &frames);
+                    if (err < 0) break;
+
+                    // Mono S16 interleaved: samples are contiguous from 'offset'
+                    const int16_t* src = (const int16_t*)((const char*)areas[0].addr + areas[0].first / 8) + offset;
+                    window.push(src, (int)frames);
+
+                    snd_pcm_sframes_t committed = snd_pcm_mmap_commit(handle, offset, frames);
+                    if (committed < 0 || (snd_pcm_uframes_t)committed != frames) {
+                        err = committed < 0 ? (int)committed : -EPIPE;
+                        break;
+                    }
+                    pending += (int)frames;
+                    avail -= frames;
+                }
+            }
+            if (err < 0) {
+                recoverCapture(handle, err);
+                continue;
+            }
+            captureNs = steadyNowNs();
+        } else {
+            // Blocking read of one hop
+            TRACE_SCOPE("audio_read");
+            int frames = snd_pcm_readi(handle, buffer, hop);
+            if (frames < 0) {
+                recoverCapture(handle, frames);
+                continue;
             }
-            continue;
+            captureNs = steadyNowNs();
+            window.push(buffer, frames);
+            pending += frames;
         }
 
-        // convert to normalized float
-        for (int i = 0; i < N; i++)
-            samples[i] = buffer[i] / 32768.0f;
+        if (pending < hop) continue;
+        // Analyse once on the newest N samples even if several hops arrived together
+        pending %= hop;
+        frameCount++;
 
-        // VOLUME (scaled by sensitivity setting)
-        float vol = 0;
-        for (int i = 0; i < N; i++)
-            vol += samples[i] * samples[i];
-        vol = sqrt(vol / N) * settings.sensitivity.load();
-        audio.volume.store(vol);
+        TRACE_SCOPE("analysis");
+        AudioFrame f;
+        f.seq = (uint64_t)frameCount;
+        f.captureNs = captureNs;
+        auto analysisStart = std::chrono::steady_clock::now();
 
-        // FFT
-        for (int i = 0; i < N; i++) {
-            in[i].r = samples[i];
-            in[i].i = 0;
-        }
+#ifdef FIXED_POINT
+        // VOLUME over the last N samples - integer sum of squares, one sqrt
+        int64_t sumSq = dsp_sum_squares_s16(window.latest(), N);
+        float vol = sqrtf((float)sumSq / N) / 32768.0f * settings.sensitivity.load();
 
-        kiss_fft(cfg, in, out);
-
-        // 8-band spectrum with logarithmic frequency bands
-        // With 44.1kHz and N=1024: each bin = ~43Hz
-        // Band boundaries designed for musical perception:
-        // Band 0: Sub-bass     20-60 Hz    (bins 1-2)
-        // Band 1: Bass         60-150 Hz   (bins 2-4)
-        // Band 2: Low-mid      150-400 Hz  (bins 4-10)
-        // Band 3: Mid          400-1kHz    (bins 10-24)
-        // Band 4: Upper-mid    1-2.5kHz    (bins 24-58)
-        // Band 5: Presence     2.5-5kHz    (bins 58-116)
-        // Band 6: Brilliance   5-10kHz     (bins 116-232)
-        // Band 7: Air          10-20kHz    (bins 232-465)
+        // FFT directly on the S16 samples (Q15)
         {
-            std::lock_guard<std::mutex> lock(audio.specMutex);
+            TRACE_SCOPE("fft");
+            window.apply(frame);
+            kiss_fftr(cfg, frame, out);
+            dsp_magnitude_q15(mag, out, magBins);
+        }
+#else
+        // VOLUME over the last N samples (scaled by sensitivity setting)
+        float vol = sqrtf(dsp_sum_squares(window.latest(), N) / N) * settings.sensitivity.load();
 
-            // Logarithmic band boundaries (bin indices)
-            const int bandStart[8] = {1,   2,   4,   10,  24,  58,  116, 232};
-            const int bandEnd[8]   = {2,   4,   10,  24,  58,  116, 232, 465};
+        // FFT
+        {
+            TRACE_SCOPE("fft");
+            window.apply(frame);
+            kiss_fftr(cfg, frame, out);
+            dsp_magnitude(mag, out, magBins);
+        }
+#endif
 
-            // Per-band gain compensation (bass naturally has more energy)
-            // Lower values = reduce gain, higher values = boost gain
-            const float bandGain[8] = {0.3f, 0.5f, 0.8f, 1.0f, 1.5f, 2.5f, 4.0f, 6.0f};
+        f.volume = vol;
 
+        // 8-band spectrum (band layout above)
+        {
+            TRACE_SCOPE("bands");
             for (int b = 0; b < 8; b++) {
-                float energy = 0;
                 int start = bandStart[b];
                 int end = bandEnd[b];
-                if (end > N/2) end = N/2;  // Don't exceed Nyquist
+                if (end > magBins) end = magBins;  // Don't exceed Nyquist
 
-                for (int i = start; i < end; i++)
-                    energy += std::sqrt(out[i].r*out[i].r + out[i].i*out[i].i);
+#ifdef FIXED_POINT
+                float energy = dsp_sum_s32(mag + start, end - start) * ((float)N / 32768.0f);  // back to float-path units
+#else
+                float energy = dsp_sum(mag + start, end - start);
+#endif
+                energy *= window.gain();  // undo window attenuation
 
                 int binCount = end - start;
                 if (binCount < 1) binCount = 1;
-                audio.spectrum[b] = (energy / binCount) * bandGain[b] * settings.sensitivity.load();
+                f.spectrum[b] = (energy / binCount) * bandGain[b] * settings.sensitivity.load();
             }
         }
 
         // BEAT DETECTION - based on low frequency energy spikes
-        float low = audio.spectrum[0] + audio.spectrum[1] + audio.spectrum[2];
+        float low = f.spectrum[0] + f.spectrum[1] + f.spectrum[2];
         float diff = low - last_energy;
-        last_energy = last_energy * 0.95f + low * 0.05f;  // slow moving average
+        last_energy = last_energy * avgKeep + low * (1.0f - avgKeep);  // slow moving average
 
         // Detect sudden increases in bass energy
         if (diff > 0.1f) {
             beat_smooth = 1.0f;  // immediate response on beat
         } else {
-            beat_smooth = beat_smooth * 0.92f;  // decay
-        }
-        audio.beat.store(beat_smooth);
-
-        // Debug every ~2 seconds (at ~43 fps audio = ~86 iterations)
-        if (frameCount % 86 == 0) {
-            std::cerr << "Vol: " << vol << " Beat: " << beat_smooth << std::endl;
-        }
-        // No sleep needed - snd_pcm_readi blocks until samples are ready
-    }
-}
-
-// ====================================================================
-// EFFECTS
-// ====================================================================
-
-// ---------------------- Volume Bars ------------------------------
-void effect_volume(FrameCanvas *c, int br) {
-    static int mode = 0;
-    static float modeTimer = 0;
-    static float hue = 0;
-    static float particleX[16], particleY[16], particleVX[16], particleVY[16];
-    static bool particlesInit = false;
-
-    float vol = audio.volume.load();
-    float beat = audio.beat.load();
-    float threshold = settings.noiseThreshold.load();
-    float dt = g_deltaTime.load();
-    float rawDt = g_rawDeltaTime.load();
-
-    if (vol < threshold) vol = 0;
-
-    // Change mode based on modeSpeed setting (uses raw time, not affected by animation speed)
-    int modeSpeedSec = settings.modeSpeed.load();
-    modeTimer += rawDt;
-    if (modeTimer > (float)modeSpeedSec) {
-        mode = (mode + 1) % 6;
-        modeTimer = 0;
-    }
-
-    // Slowly rotate hue (using deltaTime - affected by animation speed)
-    hue += 0.3f * dt;  // ~0.3 per second
-    if (hue > 1.0f) hue -= 1.0f;
-
-    // HSV to RGB
-    auto hsvRgb = [](float h, float bright) -> std::tuple<int,int,int> {
-        float hh = h * 6.0f;
-        int i = (int)hh;
-        float f = hh - i;
-        float q = 1.0f - f;
-        float r, g, b;
-        switch(i % 6) {
-            case 0: r=1; g=f; b=0; break;
-            case 1: r=q; g=1; b=0; break;
-            case 2: r=0; g=1; b=f; break;
-            case 3: r=0; g=q; b=1; break;
-            case 4: r=f; g=0; b=1; break;
-            default: r=1; g=0; b=q; break;
-        }
-        return {(int)(r*bright), (int)(g*bright), (int)(b*bright)};
-    };
-
-    // Clear screen
-    for (int y = 0; y < HEIGHT; y++)
-        for (int x = 0; x < WIDTH; x++)
-            c->SetPixel(x, y, 0, 0, 0);
-
-    int h = (int)(vol * 80);
-    if (h > HEIGHT) h = HEIGHT;
-
-    auto [cr, cg, cb] = hsvRgb(hue, br);
-
-    switch(mode) {
-        case 0: {
-            // Centered expanding bars
-            int barWidth = (int)(vol * 60) + 4;
-            if (barWidth > WIDTH/2) barWidth = WIDTH/2;
-            int cx = WIDTH/2;
-            for (int y = HEIGHT - h; y < HEIGHT; y++) {
-                float yf = (float)(y - (HEIGHT-h)) / (h > 0 ? h : 1);
-                auto [r,g,b] = hsvRgb(hue + yf * 0.3f, br);
-                for (int x = cx - barWidth; x < cx + barWidth; x++) {
-                    if (x >= 0 && x < WIDTH)
-                        c->SetPixel(x, y, r, g, b);
-                }
-            }
-            break;
-        }
-        case 1: {
-            // Rotating triangle
-            static float angle = 0;
-            angle += (2.0f + vol * 6.0f) * dt;  // Rotation speed based on volume (using deltaTime)
-
-            int cx = WIDTH / 2;
-            int cy = HEIGHT / 2;
-            float size = 15.0f + vol * 40.0f;  // Triangle size based on volume
-
-            // 3 triangle vertices
-            float angles[3] = {angle, angle + 2.094f, angle + 4.189f};  // 120 degrees apart
-            int px[3], py[3];
-            for (int i = 0; i < 3; i++) {
-                px[i] = cx + (int)(cos(angles[i]) * size);
-                py[i] = cy + (int)(sin(angles[i]) * size * 0.5f);  // Squash for aspect ratio
-            }
-
-            // Draw filled triangle using scanline
-            for (int y = 0; y < HEIGHT; y++) {
-                for (int x = 0; x < WIDTH; x++) {
-                    // Point-in-triangle test using barycentric coordinates
-                    float d1 = (float)(x - px[1]) * (py[0] - py[1]) - (px[0] - px[1]) * (y - py[1]);
-                    float d2 = (float)(x - px[2]) * (py[1] - py[2]) - (px[1] - px[2]) * (y - py[2]);
-                    float d3 = (float)(x - px[0]) * (py[2] - py[0]) - (px[2] - px[0]) * (y - py[0]);
-
-                    bool neg = (d1 < 0) || (d2 < 0) || (d3 < 0);
-                    bool pos = (d1 > 0) || (d2 > 0) || (d3 > 0);
-
-                    if (!(neg && pos)) {
-                        // Inside triangle
-                        float dx = x - cx, dy = y - cy;
-                        float dist = sqrt(dx*dx + dy*dy);
-                        float f = 1.0f - dist / (size + 1);
-                        if (f < 0.3f) f = 0.3f;
-                        auto [r,g,b] = hsvRgb(hue + dist * 0.01f, br * f);
-                        c->SetPixel(x, y, r, g, b);
-                    }
-                }
-            }
-            break;
-        }
-        case 2: {
-            // Diamond shape
-            int size = (int)(vol * 50) + 5;
-            int cx = WIDTH/2, cy = HEIGHT/2;
-            for (int y = 0; y < HEIGHT; y++) {
-                for (int x = 0; x < WIDTH; x++) {
-                    int dist = abs(x - cx) + abs(y - cy);
-                    if (dist < size) {
-                        float f = 1.0f - (float)dist / size;
-                        auto [r,g,b] = hsvRgb(hue + f * 0.2f, br * f);
-                        c->SetPixel(x, y, r, g, b);
-                    }
-                }
-            }
-            break;
-        }
-        case 3: {
-            // Horizontal mirrored bars (top and bottom)
-            int barH = h / 2;
-            for (int y = 0; y < barH; y++) {
-                float yf = (float)y / (barH > 0 ? barH : 1);
-                auto [r,g,b] = hsvRgb(hue + yf * 0.2f, br * (1.0f - yf * 0.5f));
-                for (int x = 0; x < WIDTH; x++) {
-                    c->SetPixel(x, y, r, g, b);
-                    c->SetPixel(x, HEIGHT - 1 - y, r, g, b);
-                }
-            }
-            break;
-        }
-        case 4: {
-            // Corner triangles
-            int size = (int)(vol * 60) + 5;
-            for (int y = 0; y < HEIGHT; y++) {
-                for (int x = 0; x < WIDTH; x++) {
-                    bool inTri = (x + y < size) ||
-                                 (x + (HEIGHT-y) < size) ||
-                                 ((WIDTH-x) + y < size) ||
-                                 ((WIDTH-x) + (HEIGHT-y) < size);
-                    if (inTri) {
-                        int d1 = x + y, d2 = x + (HEIGHT-y), d3 = (WIDTH-x) + y, d4 = (WIDTH-x) + (HEIGHT-y);
-                        int dist = d1;
-                        if (d2 < dist) dist = d2;
-                        if (d3 < dist) dist = d3;
-                        if (d4 < dist) dist = d4;
-                        float f = 1.0f - (float)dist / size;
-                        auto [r,g,b] = hsvRgb(hue + f * 0.3f, br * f);
-                        c->SetPixel(x, y, r, g, b);
-                    }
-                }
-            }
-            break;
-        }
-        case 5: {
-            // Concentric rings
-            int cx = WIDTH/2, cy = HEIGHT/2;
-            int maxRad = (int)(vol * 50) + 10;
-            for (int y = 0; y < HEIGHT; y++) {
-                for (int x = 0; x < WIDTH; x++) {
-                    float dx = x - cx, dy = y - cy;
-                    float dist = sqrt(dx*dx + dy*dy);
-                    if (dist < maxRad) {
-                        int ring = (int)(dist / 8);
-                        if (ring % 2 == 0) {
-                            float f = 1.0f - dist / maxRad;
-                            auto [r,g,b] = hsvRgb(hue + ring * 0.15f, br * f);
-                            c->SetPixel(x, y, r, g, b);
-                        }
-                    }
-                }
-            }
-            break;
-        }
-    }
-}
-
-// ---------------------- Beat Pulse -------------------------------
-void effect_beat(FrameCanvas *c, float t, int br) {
-    static float hue = 0;
-
-    float beat = audio.beat.load();
-    float vol = audio.volume.load();
-    float threshold = settings.noiseThreshold.load();
-    float dt = g_deltaTime.load();
-
-    // Slowly cycle hue (using deltaTime)
-    hue += 0.2f * dt;  // ~0.2 per second
-    if (hue > 1.0f) hue -= 1.0f;
-
-    // HSV to RGB helper
-    auto hsvRgb = [](float h, float bright) -> std::tuple<int,int,int> {
-        float hh = h * 6.0f;
-        int i = (int)hh;
-        float f = hh - i;
-        float q = 1.0f - f;
-        float r, g, b;
-        switch(i % 6) {
-            case 0: r=1; g=f; b=0; break;
-            case 1: r=q; g=1; b=0; break;
-            case 2: r=0; g=1; b=f; break;
-            case 3: r=0; g=q; b=1; break;
-            case 4: r=f; g=0; b=1; break;
-            default: r=1; g=0; b=q; break;
-        }
-        return {(int)(r*bright), (int)(g*bright), (int)(b*bright)};
-    };
-
-    // Clear entire screen to black first
-    for (int y = 0; y < HEIGHT; y++) {
-        for (int x = 0; x < WIDTH; x++) {
-            c->SetPixel(x, y, 0, 0, 0);
-        }
-    }
-
-    // Only draw if above noise threshold
-    if (vol < threshold && beat < threshold) {
-        return;  // stay black
-    }
-
-    // Radius based on beat and volume
-    float radius = beat * 50.0f + vol * 30.0f;
-    if (radius < 5.0f) return;
-    if (radius > 70) radius = 70;
-
-    int cx = WIDTH/2;
-    int cy = HEIGHT/2;
-
-    // Draw circle with cycling color
-    for (int y = 0; y < HEIGHT; y++) {
-        for (int x = 0; x < WIDTH; x++) {
-            float dx = x - cx;
-            float dy = y - cy;
-            float d  = sqrt(dx*dx + dy*dy);
-
-            if (d < radius) {
-                float f = 1.0f - d/radius;
-                auto [r, g, b] = hsvRgb(hue + d * 0.005f, br * f);
-                c->SetPixel(x, y, r, g, b);
-            }
-        }
-    }
-
-    // Draw frequency wave line through the middle
-    float spec[8];
-    {
-        std::lock_guard<std::mutex> lock(audio.specMutex);
-        for (int i = 0; i < 8; i++) spec[i] = audio.spectrum[i];
-    }
-
-    // Complementary color for line (opposite hue)
-    float lineHue = hue + 0.5f;
-    if (lineHue > 1.0f) lineHue -= 1.0f;
-
-    // Draw a continuous wave line based on spectrum
-    for (int x = 0; x < WIDTH; x++) {
-        // Interpolate between spectrum bands
-        float bandPos = (float)x / WIDTH * 7.0f;
-        int band1 = (int)bandPos;
-        int band2 = band1 + 1;
-        if (band2 > 7) band2 = 7;
-        float frac = bandPos - band1;
-
-        float val = spec[band1] * (1.0f - frac) + spec[band2] * frac;
-        if (val < threshold) val = 0;
-
-        int offset = (int)(val * 0.3f);
-        if (offset > 20) offset = 20;
-
-        // Line color shifts slightly across width
-        auto [lr, lg, lb] = hsvRgb(lineHue + (float)x / WIDTH * 0.2f, br);
-
-        // Draw vertical line segment (wave thickness)
-        for (int dy = -1; dy <= 1; dy++) {
-            int y = cy + offset + dy;
-            if (y >= 0 && y < HEIGHT) {
-                c->SetPixel(x, y, lr, lg, lb);
-            }
-            y = cy - offset + dy;
-            if (y >= 0 && y < HEIGHT) {
-                c->SetPixel(x, y, lr, lg, lb);
-            }
-        }
-    }
-}
-
-// Smoothed spectrum values (persistent)
-static float smoothSpec[8] = {0};
-
-// ---------------------- Spectrum Bars ----------------------------
-void effect_spectrum(FrameCanvas *c, int br) {
-    const int bands = 8;
-    int bw = WIDTH / bands;
-
-    // Copy and smooth spectrum values
-    {
-        std::lock_guard<std::mutex> lock(audio.specMutex);
-        for (int i = 0; i < 8; i++) {
-            float target = audio.spectrum[i];
-            // Smooth: fast attack, slow decay
-            if (target > smoothSpec[i]) {
-                smoothSpec[i] = target;
-            } else {
-                smoothSpec[i] = smoothSpec[i] * 0.85f + target * 0.15f;
-            }
-        }
-    }
-
-    float threshold = settings.noiseThreshold.load();
-
-    // Draw all pixels
-    for (int b = 0; b < bands; b++) {
-        float val = smoothSpec[b];
-
-        // Noise threshold
-        if (val < threshold) val = 0;
-
-        int h = (int)(val * 0.8f);
-        if (h > HEIGHT) h = HEIGHT;
-
-        // Fixed colors for each band (rainbow)
-        int r, g, bb;
-        switch(b) {
-            case 0: r = 255; g = 0;   bb = 0;   break;  // red
-            case 1: r = 255; g = 128; bb = 0;   break;  // orange
-            case 2: r = 255; g = 255; bb = 0;   break;  // yellow
-            case 3: r = 0;   g = 255; bb = 0;   break;  // green
-            case 4: r = 0;   g = 255; bb = 255; break;  // cyan
-            case 5: r = 0;   g = 0;   bb = 255; break;  // blue
-            case 6: r = 128; g = 0;   bb = 255; break;  // purple
-            case 7: r = 255; g = 0;   bb = 255; break;  // magenta
-        }
-
-        int startX = b * bw + 2;
-        int endX = (b + 1) * bw - 2;
-
-        // Draw entire column - color below, black above
-        for (int y = 0; y < HEIGHT; y++) {
-            for (int x = startX; x < endX; x++) {
-                if (y >= HEIGHT - h && h > 0) {
-                    c->SetPixel(x, y, r, g, bb);
-                } else {
-                    c->SetPixel(x, y, 0, 0, 0);
-                }
-            }
-        }
-
-        // Black gaps between bars
-        for (int y = 0; y < HEIGHT; y++) {
-            for (int x = b * bw; x < startX; x++) {
-                c->SetPixel(x, y, 0, 0, 0);
-            }
-            for (int x = endX; x < (b + 1) * bw; x++) {
-                c->SetPixel(x, y, 0, 0, 0);
-            }
-        }
-    }
-}
-
-// ---------------------- Plasma ----------------------------------
-void effect_plasma(FrameCanvas *c, float t, int br) {
-    float vol = audio.volume.load();
-    float threshold = settings.noiseThreshold.load();
-    if (vol < threshold) vol = 0;
-    vol *= 6.0f;
-
-    for (int y = 0; y < HEIGHT; y++) {
-        for (int x = 0; x < WIDTH; x++) {
-            float v = sin(x*0.09f + t)
-                    + sin(y*0.08f + t*1.4f)
-                    + sin((x+y)*0.04f + t*0.8f);
-
-            int r = (int)((sin(v + t*0.5f + vol)*0.5f+0.5f) * br);
-            int g = (int)((sin(v*1.3f + t + vol*0.5f)*0.5f+0.5f) * 255);
-            int b = (int)((sin(v*2.3f + t*0.2f)*0.5f+0.5f) * 255);
-
-            c->SetPixel(x, y, r, g, b);
-        }
-    }
-}
-
-// ---------------------- Fire -------------------------------------
-void effect_fire(FrameCanvas *c, int br) {
-    static int fire[HEIGHT][WIDTH] = {0};
-
-    // shift upward
-    for (int y = 0; y < HEIGHT-1; y++) {
-        for (int x = 0; x < WIDTH; x++) {
-            fire[y][x] = fire[y+1][x];
-        }
-    }
-
-    // Heat from audio volume
-    float vol = audio.volume.load();
-    float threshold = settings.noiseThreshold.load();
-    if (vol < threshold) vol = 0;
-    int heat = (int)(vol * 300);
-    if (heat > 255) heat = 255;
-
-    // Add heat at bottom with some randomness
-    for (int x = 0; x < WIDTH; x++) {
-        fire[HEIGHT-1][x] = heat + (rand() % 30) - 15;
-        if (fire[HEIGHT-1][x] < 0) fire[HEIGHT-1][x] = 0;
-        if (fire[HEIGHT-1][x] > 255) fire[HEIGHT-1][x] = 255;
-    }
-
-    // blur/cool
-    for (int y = 0; y < HEIGHT-1; y++) {
-        for (int x = 0; x < WIDTH; x++) {
-            int sum = fire[y][x];
-            if (x > 0) sum += fire[y][x-1];
-            if (x < WIDTH-1) sum += fire[y][x+1];
-            if (y < HEIGHT-1) sum += fire[y+1][x];
-            fire[y][x] = (sum / 4) - 2;
-            if (fire[y][x] < 0) fire[y][x] = 0;
-        }
-    }
-
-    // draw with fire colors
-    for (int y = 0; y < HEIGHT; y++) {
-        for (int x = 0; x < WIDTH; x++) {
-            int v = fire[y][x];
-            int r = v;
-            int g = v / 2;
-            int b = v / 8;
-            c->SetPixel(x, y, r, g, b);
-        }
-    }
-}
-
-// ---------------------- Raindrops --------------------------------
-void effect_rain(FrameCanvas *c, float t, int br) {
-    static float drops[32][2];  // x, y positions
-    static bool initialized = false;
-
-    if (!initialized) {
-        for (int i = 0; i < 32; i++) {
-            drops[i][0] = rand() % WIDTH;
-            drops[i][1] = rand() % HEIGHT;
-        }
-        initialized = true;
-    }
-
-    float vol = audio.volume.load();
-    float threshold = settings.noiseThreshold.load();
-    if (vol < threshold) vol = 0;
-
-    // Clear
-    for (int y = 0; y < HEIGHT; y++)
-        for (int x = 0; x < WIDTH; x++)
-            c->SetPixel(x, y, 0, 0, 0);
-
-    // Move and draw drops (using deltaTime for consistent speed)
-    float dt = g_deltaTime.load();
-    float speed = (10.0f + vol * 50.0f) * dt;  // pixels per second * dt
-    for (int i = 0; i < 32; i++) {
-        drops[i][1] += speed;
-        if (drops[i][1] >= HEIGHT) {
-            drops[i][1] = 0;
-            drops[i][0] = rand() % WIDTH;
-        }
-
-        int x = (int)drops[i][0];
-        int y = (int)drops[i][1];
-
-        // Draw drop with tail
-        for (int ty = 0; ty < 5; ty++) {
-            int py = y - ty;
-            if (py >= 0 && py < HEIGHT) {
-                int intensity = br * (5 - ty) / 5;
-                c->SetPixel(x, py, 0, intensity / 2, intensity);
-            }
-        }
-    }
-}
-
-// ---------------------- Matrix Rain ------------------------------
-void effect_matrix(FrameCanvas *c, float t, int br) {
-    static int columns[WIDTH];
-    static int speeds[WIDTH];
-    static bool initialized = false;
-
-    if (!initialized) {
-        for (int i = 0; i < WIDTH; i++) {
-            columns[i] = rand() % HEIGHT;
-            speeds[i] = 1 + rand() % 3;
-        }
-        initialized = true;
-    }
-
-    float vol = audio.volume.load();
-    float threshold = settings.noiseThreshold.load();
-    if (vol < threshold) vol = 0;
-
-    // Fade existing pixels
-    for (int y = 0; y < HEIGHT; y++) {
-        for (int x = 0; x < WIDTH; x++) {
-            c->SetPixel(x, y, 0, 0, 0);
-        }
-    }
-
-    // Update and draw columns (using deltaTime for consistent speed)
-    float dt = g_deltaTime.load();
-    static float columnPos[WIDTH] = {0};
-    float baseSpeed = 3.0f + vol * 10.0f;  // Base speed in pixels per second
-    for (int x = 0; x < WIDTH; x += 2) {
-        columnPos[x] += (speeds[x] * 1.5f + baseSpeed) * dt;
-        columns[x] = (int)columnPos[x];
-        if (columns[x] >= HEIGHT + 15) {
-            columnPos[x] = 0;
-            columns[x] = 0;
-            speeds[x] = 1 + rand() % 3;
-        }
-
-        // Draw falling trail
-        for (int i = 0; i < 15; i++) {
-            int y = columns[x] - i;
-            if (y >= 0 && y < HEIGHT) {
-                int g = br * (15 - i) / 15;
-                c->SetPixel(x, y, g / 4, g, g / 4);
-            }
-        }
-    }
-}
-
-// ---------------------- Starfield --------------------------------
-void effect_stars(FrameCanvas *c, float t, int br) {
-    static float stars[64][3];  // x, y, z
-    static bool initialized = false;
-
-    if (!initialized) {
-        for (int i = 0; i < 64; i++) {
-            stars[i][0] = (rand() % WIDTH) - WIDTH/2;
-            stars[i][1] = (rand() % HEIGHT) - HEIGHT/2;
-            stars[i][2] = 1 + rand() % 10;
-        }
-        initialized = true;
-    }
-
-    float vol = audio.volume.load();
-    float threshold = settings.noiseThreshold.load();
-    if (vol < threshold) vol = 0;
-
-    // Clear
-    for (int y = 0; y < HEIGHT; y++)
-        for (int x = 0; x < WIDTH; x++)
-            c->SetPixel(x, y, 0, 0, 0);
-
-    // Using deltaTime for consistent speed
-    float dt = g_deltaTime.load();
-    float speed = (5.0f + vol * 20.0f) * dt;  // units per second * dt
-
-    for (int i = 0; i < 64; i++) {
-        stars[i][2] -= speed;
-        if (stars[i][2] <= 0) {
-            stars[i][0] = (rand() % WIDTH) - WIDTH/2;
-            stars[i][1] = (rand() % HEIGHT) - HEIGHT/2;
-            stars[i][2] = 10;
-        }
-
-        // Project 3D to 2D
-        float px = stars[i][0] / stars[i][2] * 20 + WIDTH/2;
-        float py = stars[i][1] / stars[i][2] * 20 + HEIGHT/2;
-
-        if (px >= 0 && px < WIDTH && py >= 0 && py < HEIGHT) {
-            int intensity = (int)(br * (10 - stars[i][2]) / 10);
-            if (intensity > 255) intensity = 255;
-            c->SetPixel((int)px, (int)py, intensity, intensity, intensity);
-        }
-    }
-}
-
-// ---------------------- VU Meter ---------------------------------
-void effect_vu(FrameCanvas *c, int br) {
-    static float peakL = 0, peakR = 0;
-
-    float vol = audio.volume.load();
-    float threshold = settings.noiseThreshold.load();
-    if (vol < threshold) vol = 0;
-
-    // Simulate stereo with slight variation
-    float left = vol * (0.9f + 0.2f * sin(vol * 10));
-    float right = vol * (0.9f + 0.2f * cos(vol * 10));
-
-    // Peak hold with decay
-    if (left > peakL) peakL = left;
-    else peakL *= 0.98f;
-    if (right > peakR) peakR = right;
-    else peakR *= 0.98f;
-
-    int hL = (int)(left * 60);
-    int hR = (int)(right * 60);
-    int peakLy = (int)(peakL * 60);
-    int peakRy = (int)(peakR * 60);
-
-    if (hL > HEIGHT) hL = HEIGHT;
-    if (hR > HEIGHT) hR = HEIGHT;
-    if (peakLy > HEIGHT) peakLy = HEIGHT;
-    if (peakRy > HEIGHT) peakRy = HEIGHT;
-
-    // Clear
-    for (int y = 0; y < HEIGHT; y++)
-        for (int x = 0; x < WIDTH; x++)
-            c->SetPixel(x, y, 0, 0, 0);
-
-    // Draw left channel (0-63) - RED
-    for (int y = HEIGHT - hL; y < HEIGHT; y++) {
-        for (int x = 4; x < 60; x++) {
-            float level = (float)(HEIGHT - y) / HEIGHT;
-            int intensity = (int)(br * (0.5f + level * 0.5f));
-            c->SetPixel(x, y, intensity, 0, 0);
-        }
-    }
-
-    // Draw right channel (64-127) - GREEN
-    for (int y = HEIGHT - hR; y < HEIGHT; y++) {
-        for (int x = 68; x < 124; x++) {
-            float level = (float)(HEIGHT - y) / HEIGHT;
-            int intensity = (int)(br * (0.5f + level * 0.5f));
-            c->SetPixel(x, y, 0, intensity, 0);
-        }
-    }
-
-    // Peak indicators
-    if (peakLy > 0) {
-        int y = HEIGHT - peakLy;
-        for (int x = 4; x < 60; x++)
-            c->SetPixel(x, y, br, br, br);
-    }
-    if (peakRy > 0) {
-        int y = HEIGHT - peakRy;
-        for (int x = 68; x < 124; x++)
-            c->SetPixel(x, y, br, br, br);
-    }
-}
-
-// ---------------------- Waveform ---------------------------------
-void effect_wave(FrameCanvas *c, float t, int br) {
-    float vol = audio.volume.load();
-    float beat = audio.beat.load();
-    float threshold = settings.noiseThreshold.load();
-    if (vol < threshold) vol = 0;
-
-    float dt = g_deltaTime.load();
-
-    // Clear
-    for (int y = 0; y < HEIGHT; y++)
-        for (int x = 0; x < WIDTH; x++)
-            c->SetPixel(x, y, 0, 0, 0);
-
-    // Live waveform - each column reacts to current audio
-    int cy = HEIGHT / 2;
-    float baseAmplitude = vol * 28.0f;
-
-    // Phase offset scrolls continuously (base speed + volume boost)
-    static float phase = 0;
-    phase += dt * (3.0f + vol * 3.0f);
-
-    // Slow color cycling
-    static float hue = 0;
-    hue += dt * 0.1f;  // Full cycle in ~10 seconds
-    if (hue > 1.0f) hue -= 1.0f;
-
-    for (int x = 0; x < WIDTH; x++) {
-        // Create wave pattern that reacts to current volume
-        float wave = sinf(x * 0.15f + phase) * 0.3f +
-                     sinf(x * 0.08f - phase * 0.7f) * 0.2f +
-                     0.5f;  // base offset
-
-        // Amplitude based on live volume, modulated by wave pattern
-        int amplitude = (int)(baseAmplitude * wave + beat * 8.0f);
-        if (amplitude < 1 && vol > 0.05f) amplitude = 1;  // minimum visibility when sound
-
-        // HSV to RGB for color cycling (shifted by x position for gradient)
-        float h = hue + (float)x / WIDTH * 0.3f;  // slight gradient across width
-        if (h > 1.0f) h -= 1.0f;
-        float hh = h * 6.0f;
-        int i = (int)hh;
-        float f = hh - i;
-        float q = 1.0f - f;
-
-        float rr, gg, bb;
-        switch (i % 6) {
-            case 0: rr = 1; gg = f; bb = 0; break;
-            case 1: rr = q; gg = 1; bb = 0; break;
-            case 2: rr = 0; gg = 1; bb = f; break;
-            case 3: rr = 0; gg = q; bb = 1; break;
-            case 4: rr = f; gg = 0; bb = 1; break;
-            default: rr = 1; gg = 0; bb = q; break;
-        }
-
-        for (int dy = -amplitude; dy <= amplitude; dy++) {
-            int y = cy + dy;
-            if (y >= 0 && y < HEIGHT) {
-                float dist = (float)abs(dy) / (amplitude + 1);
-                float intensity = (1 - dist);
-                int r = (int)(br * intensity * rr);
-                int g = (int)(br * intensity * gg);
-                int b = (int)(br * intensity * bb);
-                c->SetPixel(x, y, r, g, b);
-            }
-        }
-    }
-}
-
-// ---------------------- Color Pulse ------------------------------
-void effect_colorpulse(FrameCanvas *c, float t, int br) {
-    static float hue = 0;
-
-    float vol = audio.volume.load();
-    float threshold = settings.noiseThreshold.load();
-    if (vol < threshold) vol = 0;
-
-    // Slowly shift hue over time
-    hue += 0.002f;
-    if (hue > 1.0f) hue -= 1.0f;
-
-    // Brightness based on volume
-    float intensity = 0.1f + vol * 0.9f;
-    if (intensity > 1.0f) intensity = 1.0f;
-
-    // HSV to RGB conversion
-    float h = hue * 6.0f;
-    int i = (int)h;
-    float f = h - i;
-    float q = 1.0f - f;
-
-    float r, g, b;
-    switch (i % 6) {
-        case 0: r = 1; g = f; b = 0; break;
-        case 1: r = q; g = 1; b = 0; break;
-        case 2: r = 0; g = 1; b = f; break;
-        case 3: r = 0; g = q; b = 1; break;
-        case 4: r = f; g = 0; b = 1; break;
-        case 5: r = 1; g = 0; b = q; break;
-        default: r = 1; g = 0; b = 0; break;
-    }
-
-    int pr = (int)(r * br * intensity);
-    int pg = (int)(g * br * intensity);
-    int pb = (int)(b * br * intensity);
-
-    // Fill entire screen
-    for (int y = 0; y < HEIGHT; y++) {
-        for (int x = 0; x < WIDTH; x++) {
-            c->SetPixel(x, y, pr, pg, pb);
-        }
-    }
-}
-
-// ---------------------- Color Wipe --------------------------------
-void effect_colorwipe(FrameCanvas *c, float t, int br) {
-    static float hue = 0;
-    static float prevHue = 0;
-    static int direction = 0;  // 0=left-right, 1=right-left, 2=top-bottom, 3=bottom-top
-    static float wipeProgress = 0;
-
-    float vol = audio.volume.load();
-    float threshold = settings.noiseThreshold.load();
-    if (vol < threshold) vol = 0;
-
-    // Wipe speed based on volume
-    float speed = 0.5f + vol * 2.0f;
-    wipeProgress += speed;
-
-    // Calculate wipe position
-    int maxPos;
-    if (direction == 0 || direction == 1) {
-        maxPos = WIDTH;
-    } else {
-        maxPos = HEIGHT;
-    }
-
-    int wipePos = (int)wipeProgress;
-
-    // When wipe completes, change direction and color
-    if (wipePos >= maxPos) {
-        wipeProgress = 0;
-        prevHue = hue;
-        hue += 0.15f;  // Jump to next color
-        if (hue > 1.0f) hue -= 1.0f;
-        direction = (direction + 1) % 4;  // Cycle through directions
-    }
-
-    // HSV to RGB for current color
-    auto hsvToRgb = [](float h, int brightness) -> std::tuple<int, int, int> {
-        float hh = h * 6.0f;
-        int i = (int)hh;
-        float f = hh - i;
-        float q = 1.0f - f;
-        float r, g, b;
-        switch (i % 6) {
-            case 0: r = 1; g = f; b = 0; break;
-            case 1: r = q; g = 1; b = 0; break;
-            case 2: r = 0; g = 1; b = f; break;
-            case 3: r = 0; g = q; b = 1; break;
-            case 4: r = f; g = 0; b = 1; break;
-            case 5: r = 1; g = 0; b = q; break;
-            default: r = 1; g = 0; b = 0; break;
+            beat_smooth = beat_smooth * beatDecay;  // decay
         }
-        return std::make_tuple((int)(r * brightness), (int)(g * brightness), (int)(b * brightness));
-    };
+        f.beat = beat_smooth;
 
-    auto [nr, ng, nb] = hsvToRgb(hue, br);       // New color
-    auto [pr, pg, pb] = hsvToRgb(prevHue, br);   // Previous color
-
-    // Draw based on direction
-    for (int y = 0; y < HEIGHT; y++) {
-        for (int x = 0; x < WIDTH; x++) {
-            bool useNewColor = false;
-
-            switch (direction) {
-                case 0:  // Left to right
-                    useNewColor = (x < wipePos);
-                    break;
-                case 1:  // Right to left
-                    useNewColor = (x >= WIDTH - wipePos);
-                    break;
-                case 2:  // Top to bottom
-                    useNewColor = (y < wipePos);
-                    break;
-                case 3:  // Bottom to top
-                    useNewColor = (y >= HEIGHT - wipePos);
-                    break;
-            }
+        // Publish the whole frame at once
+        audio.frame.store(f);
+        metrics.analysisUs.observe(
+            std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - analysisStart).count());
 
-            if (useNewColor) {
-                c->SetPixel(x, y, nr, ng, nb);
-            } else {
-                c->SetPixel(x, y, pr, pg, pb);
-            }
-        }
-    }
-}
-
-// ---------------------- Spectrum 3D Waterfall ------------------------
-void effect_spectrum3d(FrameCanvas *c, float t, int br) {
-    static const int HISTORY_DEPTH = 32;  // Number of history lines
-    static float history[HISTORY_DEPTH][8] = {0};  // Store spectrum history
-    static int frameCount = 0;
-
-    // Get current spectrum
-    float currentSpec[8];
-    {
-        std::lock_guard<std::mutex> lock(audio.specMutex);
-        for (int i = 0; i < 8; i++) {
-            currentSpec[i] = audio.spectrum[i];
-        }
-    }
-
-    float threshold = settings.noiseThreshold.load();
-
-    // Shift history back every few frames for slower movement
-    frameCount++;
-    if (frameCount >= 4) {
-        frameCount = 0;
-        for (int d = HISTORY_DEPTH - 1; d > 0; d--) {
-            for (int b = 0; b < 8; b++) {
-                history[d][b] = history[d-1][b];
-            }
-        }
-        // Add new spectrum line at front
-        for (int b = 0; b < 8; b++) {
-            float val = currentSpec[b];
-            if (val < threshold) val = 0;
-            history[0][b] = val;
-        }
-    }
-
-    // Clear screen
-    for (int y = 0; y < HEIGHT; y++) {
-        for (int x = 0; x < WIDTH; x++) {
-            c->SetPixel(x, y, 0, 0, 0);
-        }
-    }
-
-    // Draw 3D perspective lines - back to front so front overwrites
-    for (int d = HISTORY_DEPTH - 1; d >= 0; d--) {
-        float depthRatio = (float)d / HISTORY_DEPTH;
-
-        // Perspective: lines move up and shrink horizontally as they go back
-        int baseY = HEIGHT - 8 - (int)(depthRatio * 50);  // Move up with depth
-        float xScale = 1.0f - depthRatio * 0.5f;  // Shrink width with depth
-        int xCenter = WIDTH / 2 + (int)(depthRatio * 20);  // Shift right slightly
-        float fade = 1.0f - depthRatio * 0.8f;  // Fade with depth
-
-        if (baseY < 2) continue;
-
-        // Calculate line width at this depth
-        int lineWidth = (int)(WIDTH * 0.8f * xScale);
-        int startX = xCenter - lineWidth / 2;
-
-        // Draw horizontal line with height based on spectrum values
-        for (int x = 0; x < lineWidth; x++) {
-            int px = startX + x;
-            if (px < 0 || px >= WIDTH) continue;
-
-            // Map x position to spectrum band (interpolate between bands)
-            float bandPos = (float)x / lineWidth * 7.0f;
-            int band1 = (int)bandPos;
-            int band2 = band1 + 1;
-            if (band2 > 7) band2 = 7;
-            float frac = bandPos - band1;
-
-            // Interpolate between adjacent bands
-            float val = history[d][band1] * (1.0f - frac) + history[d][band2] * frac;
-            int h = (int)(val * 0.4f);
-            if (h > 25) h = 25;
-
-            // Color based on position (rainbow across width)
-            float hue = (float)x / lineWidth;
-            float hh = hue * 6.0f;
-            int i = (int)hh;
-            float f = hh - i;
-            float q = 1.0f - f;
-            int r, g, bb;
-            switch (i % 6) {
-                case 0: r = 255; g = (int)(f * 255); bb = 0; break;
-                case 1: r = (int)(q * 255); g = 255; bb = 0; break;
-                case 2: r = 0; g = 255; bb = (int)(f * 255); break;
-                case 3: r = 0; g = (int)(q * 255); bb = 255; break;
-                case 4: r = (int)(f * 255); g = 0; bb = 255; break;
-                case 5: r = 255; g = 0; bb = (int)(q * 255); break;
-                default: r = 255; g = 0; bb = 0; break;
-            }
-
-            // Apply brightness and depth fade
-            r = (int)(r * fade * br / 255);
-            g = (int)(g * fade * br / 255);
-            bb = (int)(bb * fade * br / 255);
-
-            // Draw the point at height offset from baseline
-            int py = baseY - h;
-            if (py >= 0 && py < HEIGHT) {
-                c->SetPixel(px, py, r, g, bb);
-            }
+        // Debug every ~2 seconds
+        if (frameCount % (2 * sampleRate / hop) == 0) {
+            std::cerr << "Vol: " << vol << " Beat: " << beat_smooth << std::endl;
         }
+        // No sleep needed - snd_pcm_wait/snd_pcm_readi block until data is ready
     }
 }
 
-// ====================================================================
-// EFFECT DISPATCHER
-// ====================================================================
-int autoEffect(float t) {
-    int duration = settings.effectDuration.load();
-    if (duration < 1) duration = 1;
-    return ((int)(t / duration)) % 13; // 13 effects now
-}
-
-void renderEffect(int id, FrameCanvas *c, float t, int br) {
-    switch(id) {
-        case 0: effect_volume(c, br); break;
-        case 1: effect_beat(c, t, br); break;
-        case 2: effect_spectrum(c, br); break;
-        case 3: effect_plasma(c, t, br); break;
-        case 4: effect_fire(c, br); break;
-        case 5: effect_rain(c, t, br); break;
-        case 6: effect_matrix(c, t, br); break;
-        case 7: effect_stars(c, t, br); break;
-        case 8: effect_vu(c, br); break;
-        case 9: effect_wave(c, t, br); break;
-        case 10: effect_colorpulse(c, t, br); break;
-        case 11: effect_colorwipe(c, t, br); break;
-        case 12: effect_spectrum3d(c, t, br); break;
-    }
-}
 
 // ====================================================================
 // WEB SERVER
@@ -1246,6 +442,10 @@ const char* HTML_PAGE = R"HTMLPAGE(
         button { width: 100%; padding: 15px; font-size: 18px; background: #e94560; color: white; border: none; border-radius: 5px; cursor: pointer; margin-top: 20px; }
         button:hover { background: #ff6b6b; }
         .status { text-align: center; padding: 10px; background: #0f3460; border-radius: 5px; margin-top: 10px; }
+        .bands { display: flex; align-items: flex-end; gap: 4px; height: 60px; margin: 10px 0; }
+        .bands div { flex: 1; height: 0; background: #00d4ff; border-radius: 2px 2px 0 0; }
+        .live { text-align: center; color: #00d4ff; margin-bottom: 10px; }
+        #preview { width: 100%; image-rendering: pixelated; background: #000; border-radius: 5px; margin-bottom: 10px; }
     </style>
 </head>
 <body>
@@ -1255,19 +455,29 @@ const char* HTML_PAGE = R"HTMLPAGE(
         <label>Effect</label>
         <select id="effect" onchange="update()">
             <option value="-1">Auto (cycle)</option>
-            <option value="0">Volume Bars</option>
-            <option value="1">Beat Pulse</option>
-            <option value="2">Spectrum</option>
-            <option value="3">Plasma</option>
-            <option value="4">Fire</option>
-            <option value="5">Rain</option>
-            <option value="6">Matrix</option>
-            <option value="7">Starfield</option>
-            <option value="8">VU Meter</option>
-            <option value="9">Waveform</option>
-            <option value="10">Color Pulse</option>
-            <option value="11">Color Wipe</option>
-            <option value="12">Spectrum 3D</option>
+        </select>
+    </div>
+
+    <div class="control">
+        <label>Live</label>
+        <div class="bands" id="bands"><div></div><div></div><div></div><div></div><div></div><div></div><div></div><div></div></div>
+        <div class="live" id="live">connecting...</div>
+        <select id="eventhz" onchange="update()">
+            <option value="10">10 updates/s</option>
+            <option value="30">30 updates/s</option>
+            <option value="60">60 updates/s</option>
+        </select>
+    </div>
+
+    <div class="control">
+        <label>Panel Preview</label>
+        <canvas id="preview" width="128" height="64"></canvas>
+        <select id="previewfps" onchange="startPreview()">
+            <option value="0">Off</option>
+            <option value="5">5 fps</option>
+            <option value="10" selected>10 fps</option>
+            <option value="20">20 fps</option>
+            <option value="30">30 fps</option>
         </select>
     </div>
 
@@ -1307,6 +517,60 @@ const char* HTML_PAGE = R"HTMLPAGE(
         <div class="value" id="animspeedVal">100%</div>
     </div>
 
+    <div class="control">
+        <label>Analysis Hop (samples)</label>
+        <select id="hop" onchange="update()">
+            <option value="128">128</option>
+            <option value="256">256</option>
+            <option value="512">512</option>
+            <option value="1024">1024 (no overlap)</option>
+        </select>
+        <label style="margin-top: 10px;">Analysis Window</label>
+        <select id="window" onchange="update()">
+            <option value="0">Rectangular</option>
+            <option value="1">Hann</option>
+            <option value="2">Blackman</option>
+        </select>
+    </div>
+
+    <div class="control">
+        <label>Frame Rate</label>
+        <select id="fps" onchange="update()">
+            <option value="30">30 fps</option>
+            <option value="45">45 fps</option>
+            <option value="60">60 fps</option>
+            <option value="90">90 fps</option>
+            <option value="120">120 fps</option>
+            <option value="0">Unlimited (vsync)</option>
+        </select>
+        <label style="margin-top: 10px;">CPU Budget</label>
+        <input type="range" id="budget" min="10" max="100" value="100" oninput="update()">
+        <div class="value" id="budgetVal">100%</div>
+        <label style="margin-top: 10px;">Render Resolution (heavy effects)</label>
+        <select id="scale" onchange="update()">
+            <option value="0">Auto</option>
+            <option value="1">Full</option>
+            <option value="2">Half</option>
+            <option value="4">Quarter</option>
+        </select>
+        <label style="margin-top: 10px;">Upscale Filter</label>
+        <select id="filter" onchange="update()">
+            <option value="0">Nearest</option>
+            <option value="1">Bilinear</option>
+        </select>
+    </div>
+
+    <div class="control">
+        <label>Transition</label>
+        <select id="transition" onchange="update()">
+            <option value="0">Cut</option>
+            <option value="1">Crossfade</option>
+            <option value="2">Wipe</option>
+        </select>
+        <input type="range" id="transitionms" min="100" max="3000" step="100" value="600" oninput="update()">
+        <div class="value" id="transitionmsVal">600ms</div>
+    </div>
+
     <div class="control">
         <label style="display: inline;">Auto Loop Effects</label>
         <input type="checkbox" id="autoloop" checked onchange="update()" style="width: 24px; height: 24px; margin-left: 10px; vertical-align: middle;">
@@ -1316,7 +580,28 @@ const char* HTML_PAGE = R"HTMLPAGE(
     <div class="status" id="status">Ready</div>
 
     <script>
-        function update() {
+        // One /set request in flight at a time; slider moves made while it
+        // is pending are folded into a single follow-up with the latest values
+        var setPending = false, setDirty = false;
+
+        function sendSettings() {
+            if (setPending) {
+                setDirty = true;
+                return;
+            }
+            setPending = true;
+            setDirty = false;
+            fetch(settingsQuery())
+                .then(r => r.text())
+                .then(t => document.getElementById("status").textContent = t)
+                .catch(e => document.getElementById("status").textContent = "Error: " + e)
+                .finally(() => {
+                    setPending = false;
+                    if (setDirty) sendSettings();
+                });
+        }
+
+        function settingsQuery() {
             var effect = document.getElementById("effect").value;
             var brightness = document.getElementById("brightness").value;
             var sensitivity = document.getElementById("sensitivity").value;
@@ -1325,6 +610,34 @@ const char* HTML_PAGE = R"HTMLPAGE(
             var modespeed = document.getElementById("modespeed").value;
             var animspeed = document.getElementById("animspeed").value;
             var autoloop = document.getElementById("autoloop").checked ? 1 : 0;
+            var hop = document.getElementById("hop").value;
+            var windowType = document.getElementById("window").value;
+            var fps = document.getElementById("fps").value;
+            var budget = document.getElementById("budget").value;
+            var scale = document.getElementById("scale").value;
+            var transition = document.getElementById("transition").value;
+            var transitionms = document.getElementById("transitionms").value;
+            var filter = document.getElementById("filter").value;
+            var eventhz = document.getElementById("eventhz").value;
+
+            return "/set?effect=" + effect + "&brightness=" + brightness +
+                   "&sensitivity=" + sensitivity + "&threshold=" + threshold +
+                   "&duration=" + duration + "&modespeed=" + modespeed + "&animspeed=" + animspeed + "&autoloop=" + autoloop +
+                   "&hop=" + hop + "&window=" + windowType + "&fps=" + fps + "&budget=" + budget +
+                   "&scale=" + scale + "&filter=" + filter +
+                   "&transition=" + transition + "&transitionms=" + transitionms + "&eventhz=" + eventhz;
+        }
+
+        function update() {
+            var brightness = document.getElementById("brightness").value;
+            var sensitivity = document.getElementById("sensitivity").value;
+            var threshold = document.getElementById("threshold").value;
+            var duration = document.getElementById("duration").value;
+            var modespeed = document.getElementById("modespeed").value;
+            var animspeed = document.getElementById("animspeed").value;
+            var autoloop = document.getElementById("autoloop").checked ? 1 : 0;
+            var budget = document.getElementById("budget").value;
+            var transitionms = document.getElementById("transitionms").value;
 
             document.getElementById("brightnessVal").textContent = brightness;
             document.getElementById("sensitivityVal").textContent = sensitivity + "%";
@@ -1332,20 +645,111 @@ const char* HTML_PAGE = R"HTMLPAGE(
             document.getElementById("durationVal").textContent = duration + "s";
             document.getElementById("modespeedVal").textContent = modespeed + "s";
             document.getElementById("animspeedVal").textContent = animspeed + "%";
+            document.getElementById("budgetVal").textContent = budget + "%";
+            document.getElementById("transitionmsVal").textContent = transitionms + "ms";
             document.getElementById("autoloopStatus").textContent = autoloop ? "ON" : "OFF";
 
-            fetch("/set?effect=" + effect + "&brightness=" + brightness +
-                  "&sensitivity=" + sensitivity + "&threshold=" + threshold +
-                  "&duration=" + duration + "&modespeed=" + modespeed + "&animspeed=" + animspeed + "&autoloop=" + autoloop)
-                .then(r => r.text())
-                .then(t => document.getElementById("status").textContent = t)
-                .catch(e => document.getElementById("status").textContent = "Error: " + e);
+            sendSettings();
+        }
+
+        // Live audio features pushed by the server (/events)
+        var bandBars = document.querySelectorAll("#bands div");
+        var events = new EventSource("/events");
+        events.onmessage = function(e) {
+            var d = JSON.parse(e.data);
+            d.bands.forEach(function(v, i) {
+                bandBars[i].style.height = Math.min(100, v * 1.25) + "%";  // 80 = full bar
+            });
+            document.getElementById("live").textContent = d.name + " | " + d.fps.toFixed(1) + " fps | vol " +
+                d.volume.toFixed(2) + (d.beat > 0.5 ? " | BEAT" : "");
+        };
+
+        // Panel preview (/preview): length-prefixed delta frames, format in preview.h
+        var pview = document.getElementById("preview");
+        var pctx = pview.getContext("2d");
+        var pimg = pctx.createImageData(pview.width, pview.height);
+        var previewAbort = null;
+
+        function applyPreviewFrame(b, p, end) {
+            var w = b[p + 1] | b[p + 2] << 8, h = b[p + 3] | b[p + 4] << 8;
+            if (w != pview.width || h != pview.height) {
+                pview.width = w;
+                pview.height = h;
+                pimg = pctx.createImageData(w, h);
+            }
+            var px = pimg.data;
+            if (b[p] & 1) {
+                for (var k = 0; k < px.length; k += 4) {
+                    px[k] = px[k + 1] = px[k + 2] = 0;
+                    px[k + 3] = 255;
+                }
+            }
+            p += 5;
+            var i = 0;
+            while (p < end) {
+                var op = b[p++], n;
+                if (op < 0x40) {
+                    i += op + 1;
+                } else if (op < 0x80) {
+                    for (n = op - 0x3F; n > 0; n--, i++, p += 3) {
+                        px[i * 4] = b[p]; px[i * 4 + 1] = b[p + 1]; px[i * 4 + 2] = b[p + 2];
+                    }
+                } else {
+                    for (n = op - 0x7F; n > 0; n--, i++) {
+                        px[i * 4] = b[p]; px[i * 4 + 1] = b[p + 1]; px[i * 4 + 2] = b[p + 2];
+                    }
+                    p += 3;
+                }
+            }
+            pctx.putImageData(pimg, 0, 0);
         }
 
+        function startPreview() {
+            if (previewAbort) previewAbort.abort();
+            previewAbort = null;
+            var fps = document.getElementById("previewfps").value;
+            if (fps == 0) return;
+            previewAbort = new AbortController();
+            fetch("/preview?fps=" + fps, { signal: previewAbort.signal })
+                .then(r => {
+                    if (!r.ok) throw new Error("preview " + r.status);
+                    var reader = r.body.getReader();
+                    var buf = new Uint8Array(0);
+                    function pump() {
+                        return reader.read().then(res => {
+                            if (res.done) return;
+                            var data = new Uint8Array(buf.length + res.value.length);
+                            data.set(buf);
+                            data.set(res.value, buf.length);
+                            var p = 0;
+                            while (data.length - p >= 4) {
+                                var len = (data[p] | data[p + 1] << 8 | data[p + 2] << 16 | data[p + 3] << 24) >>> 0;
+                                if (data.length - p - 4 < len) break;
+                                applyPreviewFrame(data, p + 4, p + 4 + len);
+                                p += 4 + len;
+                            }
+                            buf = data.slice(p);
+                            return pump();
+                        });
+                    }
+                    return pump();
+                })
+                .catch(e => {});
+        }
+        startPreview();
+
         // Load current values on page load
         fetch("/status")
             .then(r => r.json())
             .then(data => {
+                // Effect list comes from the server's effect registry
+                var effectSel = document.getElementById("effect");
+                data.effects.forEach(function(name, i) {
+                    var opt = document.createElement("option");
+                    opt.value = i;
+                    opt.textContent = name;
+                    effectSel.appendChild(opt);
+                });
                 document.getElementById("effect").value = data.effect;
                 document.getElementById("brightness").value = data.brightness;
                 document.getElementById("sensitivity").value = data.sensitivity;
@@ -1354,6 +758,17 @@ const char* HTML_PAGE = R"HTMLPAGE(
                 document.getElementById("modespeed").value = data.modespeed;
                 document.getElementById("animspeed").value = data.animspeed;
                 document.getElementById("autoloop").checked = data.autoloop;
+                document.getElementById("hop").value = data.hop;
+                document.getElementById("window").value = data.window;
+                document.getElementById("fps").value = data.fps;
+                document.getElementById("budget").value = data.budget;
+                document.getElementById("budgetVal").textContent = data.budget + "%";
+                document.getElementById("scale").value = data.scale;
+                document.getElementById("filter").value = data.filter;
+                document.getElementById("transition").value = data.transition;
+                document.getElementById("transitionms").value = data.transition_ms;
+                document.getElementById("eventhz").value = data.event_hz;
+                document.getElementById("transitionmsVal").textContent = data.transition_ms + "ms";
                 document.getElementById("brightnessVal").textContent = data.brightness;
                 document.getElementById("sensitivityVal").textContent = data.sensitivity + "%";
                 document.getElementById("thresholdVal").textContent = data.threshold.toFixed(2);
@@ -1367,44 +782,162 @@ const char* HTML_PAGE = R"HTMLPAGE(
 </html>
 )HTMLPAGE";
 
-void handleClient(int clientSocket) {
-    char buffer[2048] = {0};
-    read(clientSocket, buffer, 2048);
+static HttpServer* g_httpServer = nullptr;
+static StaticAsset g_indexPage;  // HTML_PAGE, gzipped once at startup
 
-    std::string request(buffer);
-    std::string response;
+// Prometheus text exposition of metrics.h plus the pipeline/server stats
+static void writeMetrics(std::string& out) {
+    static const char* RECOVERY_LABELS[RECOVER_KINDS] = {
+        "reason=\"overrun\"", "reason=\"io\"", "reason=\"other\"",
+    };
+    out.reserve(16384);
+
+    writeMetricHeader(out, "audio_capture_recoveries_total", "counter",
+                      "Capture errors recovered (overrun = EPIPE, io = EIO, other = snd_pcm_recover).");
+    for (int k = 0; k < RECOVER_KINDS; k++)
+        writeMetricValue(out, "audio_capture_recoveries_total", RECOVERY_LABELS[k],
+                         (double)metrics.captureRecoveries[k].value());
+
+    writeMetricHeader(out, "audio_analysis_seconds", "histogram",
+                      "Analysis time per hop: window, FFT, bands and beat detection.");
+    metrics.analysisUs.write(out, "audio_analysis_seconds", "");
+
+    int effects = std::min(effectCount(), (int)Metrics::MAX_EFFECTS);
+    char labels[96];
+    writeMetricHeader(out, "render_effect_seconds", "histogram", "Time of one effect render call.");
+    for (int i = 0; i < effects; i++) {
+        snprintf(labels, sizeof(labels), "effect=\"%s\"", effectName(i));
+        metrics.effectUs[i].write(out, "render_effect_seconds", labels);
+    }
+    writeMetricHeader(out, "render_effect_over_budget_total", "counter",
+                      "Effect render calls that took longer than their frame budget.");
+    for (int i = 0; i < effects; i++) {
+        snprintf(labels, sizeof(labels), "effect=\"%s\"", effectName(i));
+        writeMetricValue(out, "render_effect_over_budget_total", labels, (double)metrics.effectOverBudget[i].value());
+    }
+
+    writeMetricHeader(out, "render_fps", "gauge", "Measured render rate.");
+    writeMetricValue(out, "render_fps", "", pipeline.achievedFps.load());
+    writeMetricHeader(out, "render_frames_missed_total", "counter", "Frames started after their deadline.");
+    writeMetricValue(out, "render_frames_missed_total", "", (double)pipeline.missed.load());
+    writeMetricHeader(out, "render_audio_latency_seconds", "gauge",
+                      "Capture of the newest samples to the start of the frame that uses them (smoothed).");
+    writeMetricValue(out, "render_audio_latency_seconds", "", pipeline.audioLatencyUs.load() / 1e6);
+    writeMetricHeader(out, "render_scale", "gauge", "Divisor the last frame was rendered at.");
+    writeMetricValue(out, "render_scale", "", pipeline.renderScale.load());
+
+    writeMetricHeader(out, "present_swap_wait_seconds", "histogram", "Presenter time blocked in SwapOnVSync.");
+    metrics.swapWaitUs.write(out, "present_swap_wait_seconds", "");
+    writeMetricHeader(out, "present_frames_total", "counter", "Frames presented.");
+    writeMetricValue(out, "present_frames_total", "", (double)pipeline.frames.load());
+    writeMetricHeader(out, "present_starved_total", "counter",
+                      "Vsyncs with no finished frame while rendering was behind (governor pacing excluded).");
+    writeMetricValue(out, "present_starved_total", "", (double)pipeline.starved.load());
+
+    writeMetricHeader(out, "http_requests_total", "counter", "HTTP requests served.");
+    writeMetricValue(out, "http_requests_total", "", g_httpServer ? (double)g_httpServer->requestCount() : 0);
+    writeMetricHeader(out, "http_connections", "gauge", "Open HTTP connections.");
+    writeMetricValue(out, "http_connections", "", g_httpServer ? g_httpServer->openConnections() : 0);
+    writeMetricHeader(out, "http_event_clients", "gauge", "Connections subscribed to /events.");
+    writeMetricValue(out, "http_event_clients", "", g_httpServer ? g_httpServer->subscriberCount() : 0);
+    writeMetricHeader(out, "http_preview_clients", "gauge", "Connections streaming /preview.");
+    writeMetricValue(out, "http_preview_clients", "", previewClientCount());
+}
+
+HttpResponse handleRequest(const HttpRequest& req) {
+    TRACE_SCOPE("http_request");
+    HttpResponse response;
+    const std::string& query = req.query;
 
-    if (request.find("GET /set?") != std::string::npos) {
+    if (req.path == "/set") {
         // Parse parameters
         size_t pos;
-        if ((pos = request.find("effect=")) != std::string::npos) {
-            settings.currentEffect.store(atoi(request.c_str() + pos + 7));
+        if ((pos = query.find("effect=")) != std::string::npos) {
+            settings.currentEffect.store(atoi(query.c_str() + pos + 7));
+        }
+        if ((pos = query.find("brightness=")) != std::string::npos) {
+            settings.brightness.store(atoi(query.c_str() + pos + 11));
         }
-        if ((pos = request.find("brightness=")) != std::string::npos) {
-            settings.brightness.store(atoi(request.c_str() + pos + 11));
+        if ((pos = query.find("sensitivity=")) != std::string::npos) {
+            settings.sensitivity.store(atof(query.c_str() + pos + 12));
         }
-        if ((pos = request.find("sensitivity=")) != std::string::npos) {
-            settings.sensitivity.store(atof(request.c_str() + pos + 12));
+        if ((pos = query.find("threshold=")) != std::string::npos) {
+            settings.noiseThreshold.store(atof(query.c_str() + pos + 10) / 100.0f);
         }
-        if ((pos = request.find("threshold=")) != std::string::npos) {
-            settings.noiseThreshold.store(atof(request.c_str() + pos + 10) / 100.0f);
+        if ((pos = query.find("duration=")) != std::string::npos) {
+            settings.effectDuration.store(atoi(query.c_str() + pos + 9));
         }
-        if ((pos = request.find("duration=")) != std::string::npos) {
-            settings.effectDuration.store(atoi(request.c_str() + pos + 9));
+        if ((pos = query.find("modespeed=")) != std::string::npos) {
+            settings.modeSpeed.store(atoi(query.c_str() + pos + 10));
         }
-        if ((pos = request.find("modespeed=")) != std::string::npos) {
-            settings.modeSpeed.store(atoi(request.c_str() + pos + 10));
+        if ((pos = query.find("animspeed=")) != std::string::npos) {
+            settings.animSpeed.store(atoi(query.c_str() + pos + 10));
         }
-        if ((pos = request.find("animspeed=")) != std::string::npos) {
-            settings.animSpeed.store(atoi(request.c_str() + pos + 10));
+        if ((pos = query.find("autoloop=")) != std::string::npos) {
+            settings.autoLoop.store(atoi(query.c_str() + pos + 9) != 0);
         }
-        if ((pos = request.find("autoloop=")) != std::string::npos) {
-            settings.autoLoop.store(atoi(request.c_str() + pos + 9) != 0);
+        if ((pos = query.find("hop=")) != std::string::npos) {
+            settings.hopSize.store(std::max(64, std::min(FFT_SIZE, atoi(query.c_str() + pos + 4))));
+        }
+        if ((pos = query.find("window=")) != std::string::npos) {
+            int window = atoi(query.c_str() + pos + 7);
+            settings.window.store(window >= WINDOW_RECT && window <= WINDOW_BLACKMAN ? window : WINDOW_HANN);
+        }
+        if ((pos = query.find("fps=")) != std::string::npos) {
+            int fps = atoi(query.c_str() + pos + 4);
+            settings.targetFps.store(fps <= 0 ? 0 : std::max(5, std::min(240, fps)));
+        }
+        if ((pos = query.find("budget=")) != std::string::npos) {
+            settings.cpuBudget.store(std::max(10, std::min(100, atoi(query.c_str() + pos + 7))));
+        }
+        if ((pos = query.find("scale=")) != std::string::npos) {
+            int scale = atoi(query.c_str() + pos + 6);
+            settings.renderScale.store(scale == 1 || scale == 2 || scale == 4 ? scale : 0);
+        }
+        if ((pos = query.find("transition=")) != std::string::npos) {
+            settings.transition.store(std::max(0, std::min(2, atoi(query.c_str() + pos + 11))));
+        }
+        if ((pos = query.find("transitionms=")) != std::string::npos) {
+            settings.transitionMs.store(std::max(0, std::min(5000, atoi(query.c_str() + pos + 13))));
+        }
+        if ((pos = query.find("filter=")) != std::string::npos) {
+            settings.upscaleFilter.store(atoi(query.c_str() + pos + 7) ? UPSCALE_BILINEAR : UPSCALE_NEAREST);
+        }
+        if ((pos = query.find("eventhz=")) != std::string::npos) {
+            settings.eventRate.store(std::max(1, std::min(60, atoi(query.c_str() + pos + 8))));
+            if (g_httpServer) g_httpServer->setEventRate(settings.eventRate.load());
         }
 
-        response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\n\r\nSettings updated!";
+        response.body = "Settings updated!";
+    }
+    else if (req.path == "/events") {
+        response.eventStream = true;
+    }
+    else if (req.path == "/preview") {
+        size_t pos = query.find("fps=");
+        int fps = pos != std::string::npos ? atoi(query.c_str() + pos + 4) : 10;
+        response.stream.reset(PreviewStream::create(std::max(1, std::min(30, fps))));
+        if (!response.stream) {
+            response.status = 503;
+            response.body = "Too many preview clients";
+        }
+    }
+    else if (req.path == "/trace") {
+        // Chrome / Perfetto trace of the last N seconds (make TRACE=1)
+        size_t pos = query.find("seconds=");
+        double seconds = pos != std::string::npos ? atof(query.c_str() + pos + 8) : 5.0;
+        if (traceExport(std::max(0.1, std::min(60.0, seconds)), response.body)) {
+            response.contentType = "application/json";
+        } else {
+            response.status = 404;
+            response.body = "Tracing is compiled out; rebuild with make TRACE=1";
+        }
     }
-    else if (request.find("GET /status") != std::string::npos) {
+    else if (req.path == "/metrics") {
+        response.contentType = "text/plain; version=0.0.4";
+        writeMetrics(response.body);
+    }
+    else if (req.path == "/status") {
         std::ostringstream json;
         json << "{\"effect\":" << settings.currentEffect.load()
              << ",\"brightness\":" << settings.brightness.load()
@@ -1413,56 +946,272 @@ void handleClient(int clientSocket) {
              << ",\"duration\":" << settings.effectDuration.load()
              << ",\"modespeed\":" << settings.modeSpeed.load()
              << ",\"animspeed\":" << settings.animSpeed.load()
-             << ",\"autoloop\":" << (settings.autoLoop.load() ? "true" : "false") << "}";
-        response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n\r\n" + json.str();
+             << ",\"autoloop\":" << (settings.autoLoop.load() ? "true" : "false")
+             << ",\"hop\":" << settings.hopSize.load()
+             << ",\"fftsize\":" << FFT_SIZE
+             << ",\"window\":" << settings.window.load()
+             << ",\"fps\":" << settings.targetFps.load()
+             << ",\"budget\":" << settings.cpuBudget.load()
+             << ",\"achieved_fps\":" << pipeline.achievedFps.load()
+             << ",\"budget_us\":" << pipeline.frameBudgetUs.load()
+             << ",\"missed\":" << pipeline.missed.load()
+             << ",\"scale\":" << settings.renderScale.load()
+             << ",\"filter\":" << settings.upscaleFilter.load()
+             << ",\"render_scale\":" << pipeline.renderScale.load()
+             << ",\"transition\":" << settings.transition.load()
+             << ",\"transition_ms\":" << settings.transitionMs.load()
+             << ",\"transitions\":" << pipeline.transitions.load()
+             << ",\"transitions_cut\":" << pipeline.transitionsCut.load()
+             << ",\"blend\":\"" << blend_variant() << "\""
+             << ",\"effects_loaded\":" << loadedEffectCount()
+             << ",\"effect_bytes\":" << loadedEffectBytes()
+             << ",\"effects\":[";
+        for (int i = 0; i < effectCount(); i++)
+            json << (i ? "," : "") << "\"" << effectName(i) << "\"";
+        json << "]"
+             << ",\"capture\":\"" << (capture.mmap.load() ? "mmap" : "read") << "\""
+             << ",\"rate\":" << capture.rate.load()
+             << ",\"period\":" << capture.period.load()
+             << ",\"buffer\":" << capture.bufferSize.load()
+             << ",\"threads\":" << (g_renderPool ? g_renderPool->threads() : 1)
+             << ",\"canvases\":" << pipeline.canvases.load()
+             << ",\"queue\":" << pipeline.queueDepth.load()
+             << ",\"render_us\":" << pipeline.renderUs.load()
+             << ",\"blit_us\":" << pipeline.blitUs.load()
+             << ",\"present_us\":" << pipeline.presentUs.load()
+             << ",\"latency_us\":" << pipeline.latencyUs.load()
+             << ",\"audio_latency_us\":" << pipeline.audioLatencyUs.load()
+             << ",\"frames\":" << pipeline.frames.load()
+             << ",\"starved\":" << pipeline.starved.load()
+             << ",\"http_conns\":" << (g_httpServer ? g_httpServer->openConnections() : 0)
+             << ",\"http_requests\":" << (g_httpServer ? g_httpServer->requestCount() : 0)
+             << ",\"event_hz\":" << settings.eventRate.load()
+             << ",\"event_clients\":" << (g_httpServer ? g_httpServer->subscriberCount() : 0)
+             << ",\"events_sent\":" << (g_httpServer ? g_httpServer->eventsSent() : 0)
+             << ",\"events_dropped\":" << (g_httpServer ? g_httpServer->eventsDropped() : 0)
+             << ",\"preview_clients\":" << previewClientCount()
+             << ",\"preview_bytes\":" << previewBytesSent() << "}";
+        response.contentType = "application/json";
+        response.body = json.str();
     }
     else {
-        response = "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\n\r\n";
-        response += HTML_PAGE;
+        response.asset = &g_indexPage;
     }
 
-    write(clientSocket, response.c_str(), response.length());
-    close(clientSocket);
+    return response;
 }
 
-void webServerThread() {
-    int serverSocket = socket(AF_INET, SOCK_STREAM, 0);
-    if (serverSocket < 0) {
-        std::cerr << "Failed to create web server socket\n";
-        return;
+// One /events message. Runs on the web server thread once per tick and
+// goes to every subscriber, so it writes into the server's fixed buffer.
+static void writeLiveEvent(MessageWriter& m) {
+    AudioFrame a = audio.frame.load();
+    int id = pipeline.activeEffect.load();
+
+    m.raw("{\"seq\":");
+    m.integer((long long)a.seq);
+    m.raw(",\"volume\":");
+    m.fixed(a.volume, 3);
+    m.raw(",\"beat\":");
+    m.fixed(a.beat, 2);
+    m.raw(",\"bands\":[");
+    for (int b = 0; b < 8; b++) {
+        if (b) m.raw(",");
+        m.fixed(a.spectrum[b], 1);
     }
+    m.raw("],\"effect\":");
+    m.integer(id);
+    m.raw(",\"name\":\"");
+    m.raw(id >= 0 && id < effectCount() ? effectName(id) : "");
+    m.raw("\",\"fps\":");
+    m.fixed(pipeline.achievedFps.load(), 1);
+    m.raw("}");
+}
 
-    int opt = 1;
-    setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+void webServerThread() {
+    TRACE_THREAD("web");
+    // no-cache: browsers revalidate with If-None-Match and get a 304
+    g_indexPage = makeStaticAsset("text/html", HTML_PAGE, "no-cache");
+
+    HttpServer server(8080, handleRequest);
+    server.setEventSource(writeLiveEvent);
+    server.setEventRate(settings.eventRate.load());
+    if (!server.start()) return;
+    g_httpServer = &server;
+    std::cerr << "Web server running on http://0.0.0.0:8080\n";
+    server.run();
+}
 
-    struct sockaddr_in addr;
-    addr.sin_family = AF_INET;
-    addr.sin_addr.s_addr = INADDR_ANY;
-    addr.sin_port = htons(8080);
+// ====================================================================
+// RENDER / PRESENT PIPELINE
+// ====================================================================
+// The render thread draws each frame into a free canvas and queues it;
+// the presenter (main thread) swaps queued canvases onto the panel on
+// vsync and returns the one that went off screen to the free list.
+// Rendering the next frame overlaps the wait for vsync, and a slow frame
+// only delays its own swap while the panel keeps showing the last one.
+#ifndef HEADLESS
+typedef FrameCanvas OutputCanvas;
+#else
+typedef MemoryCanvas OutputCanvas;
+#endif
+
+// Canvases cycling between the two threads; one more is on screen
+static const int FRAME_CANVASES = 2;
+
+struct ReadyFrame {
+    OutputCanvas* canvas = nullptr;
+    int brightness = 0;
+    std::chrono::steady_clock::time_point doneAt;
+};
 
-    if (bind(serverSocket, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
-        std::cerr << "Failed to bind web server to port 8080\n";
-        close(serverSocket);
-        return;
-    }
+typedef FrameQueue<OutputCanvas*> CanvasQueue;
+typedef FrameQueue<ReadyFrame> ReadyQueue;
 
-    listen(serverSocket, 5);
-    std::cerr << "Web server running on http://0.0.0.0:8080\n";
+static float elapsedUs(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b) {
+    return std::chrono::duration<float, std::micro>(b - a).count();
+}
+
+// Exponential average over ~16 frames (single writer per field)
+static void smoothStat(std::atomic<float>& avg, float value) {
+    float old = avg.load(std::memory_order_relaxed);
+    avg.store(old + (value - old) / 16.0f, std::memory_order_relaxed);
+}
+
+void renderThread(CanvasQueue& freeCanvases, ReadyQueue& readyFrames) {
+    TRACE_THREAD("render");
+    FrameBuffer frame(WIDTH, HEIGHT);     // effects draw here, then one blit per frame
+    FrameBuffer frameOut(WIDTH, HEIGHT);  // outgoing effect during a transition
+    ScaledRenderer effects;
+    FrameGovernor governor;
+    Transition transition;
+    int shownEffect = -1;
+
+    auto t0 = std::chrono::steady_clock::now();
+    auto lastFrame = std::chrono::steady_clock::now();
 
     while (true) {
-        struct sockaddr_in clientAddr;
-        socklen_t clientLen = sizeof(clientAddr);
-        int clientSocket = accept(serverSocket, (struct sockaddr*)&clientAddr, &clientLen);
-        if (clientSocket >= 0) {
-            handleClient(clientSocket);
+        // Sleep until the next frame is due (target FPS / CPU budget)
+        governor.waitForFrame();
+
+        // Blocks while every canvas is queued or on screen
+        OutputCanvas* canvas = freeCanvases.pop();
+        TRACE_SCOPE("render_frame");
+
+        auto now = std::chrono::steady_clock::now();
+        float timeSec = std::chrono::duration<float>(now - t0).count();
+
+        // Calculate delta time since last frame
+        float dt = std::chrono::duration<float>(now - lastFrame).count();
+        lastFrame = now;
+        g_rawDeltaTime.store(dt);  // Raw time for timers (mode changes etc)
+        float speedMult = settings.animSpeed.load() / 100.0f;
+        g_deltaTime.store(dt * speedMult);  // Scaled time for animations
+
+        // One consistent audio snapshot for the whole frame
+        g_audio = audio.frame.load();
+        if (g_audio.seq) {
+            int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+            smoothStat(pipeline.audioLatencyUs, (nowNs - g_audio.captureNs) / 1000.0f);
         }
+
+        int manualEffect = settings.currentEffect.load();
+
+        // Choose effect
+        int id;
+        bool loopEnabled = settings.autoLoop.load();
+        if (manualEffect >= 0 && manualEffect < effectCount()) {
+            // Manual effect selected - use it directly
+            id = manualEffect;
+        } else if (loopEnabled) {
+            // Auto mode with loop enabled - cycle through effects
+            id = autoEffect(timeSec);
+        } else {
+            // Auto mode with loop disabled - stay on effect 0
+            id = 0;
+        }
+
+        // Effect changed: fade out the one on screen
+        if (id != shownEffect) {
+            if (shownEffect >= 0) {
+                transition.start(shownEffect, settings.transition.load(), settings.transitionMs.load() / 1000.0f);
+                if (transition.active()) pipeline.transitions.fetch_add(1, std::memory_order_relaxed);
+            }
+            shownEffect = id;
+            pipeline.activeEffect.store(id, std::memory_order_relaxed);
+        }
+
+        float budget = pipeline.frameBudgetUs.load();
+        if (budget <= 0) budget = 16667.0f;
+
+        // Always render at full brightness; during a transition the two
+        // effects share the frame budget
+        float effectBudget = transition.active() ? budget / 2 : budget;
+        int scale = effects.render(id, frame, timeSec, 255, effectBudget);
+        auto effectDone = std::chrono::steady_clock::now();
+        metrics.observeEffect(id, elapsedUs(now, effectDone), effectBudget);
+        if (transition.active()) {
+            effects.render(transition.source(), frameOut, timeSec, 255, effectBudget);
+            metrics.observeEffect(transition.source(), elapsedUs(effectDone, std::chrono::steady_clock::now()),
+                                  effectBudget);
+            transition.compose(frame, frameOut, frame, dt);
+        }
+        endEffectFrame();
+        auto rendered = std::chrono::steady_clock::now();
+
+        // Two effects plus the blend did not fit: finish with a cut
+        if (transition.active() && elapsedUs(now, rendered) > budget) {
+            transition.stop();
+            pipeline.transitionsCut.fetch_add(1, std::memory_order_relaxed);
+        }
+        pipeline.renderScale.store(scale);
+
+        {
+            TRACE_SCOPE("blit");
+#ifndef HEADLESS
+            MatrixCanvas(canvas).Blit(frame);
+#else
+            canvas->Blit(frame);
+#endif
+        }
+        auto blitted = std::chrono::steady_clock::now();
+
+        // Remote preview gets the same frame (copied only when a client wants one)
+        previewTap.offer(frame);
+
+        smoothStat(pipeline.renderUs, elapsedUs(now, rendered));
+        smoothStat(pipeline.blitUs, elapsedUs(rendered, blitted));
+        governor.frameDone(elapsedUs(now, blitted));
+
+        ReadyFrame ready;
+        ready.canvas = canvas;
+        ready.brightness = settings.brightness.load();
+        ready.doneAt = blitted;
+        readyFrames.push(ready);
+        pipeline.queueDepth.store((int)readyFrames.size());
     }
 }
 
 // ====================================================================
 // MAIN
 // ====================================================================
-int main() {
+int main(int argc, char** argv) {
+    int renderThreads = defaultRenderThreads();
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--capture=rw") == 0) {
+            g_preferMmapCapture = false;   // old snd_pcm_readi capture path
+        } else if (strcmp(argv[i], "--capture=mmap") == 0) {
+            g_preferMmapCapture = true;
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            renderThreads = atoi(argv[i] + 10);   // 1 = no extra render workers
+            if (renderThreads < 1) renderThreads = 1;
+        } else {
+            std::cerr << "Unknown option: " << argv[i] << "\n";
+            std::cerr << "Usage: " << argv[0] << " [--capture=mmap|rw] [--threads=N]\n";
+            return 1;
+        }
+    }
+
+#ifndef HEADLESS
     // LED INIT FIRST
     std::cerr << "Initializing LED matrix...\n";
     RGBMatrix::Options opt;
@@ -1482,7 +1231,27 @@ int main() {
     }
     std::cerr << "LED matrix initialized OK\n";
 
-    FrameCanvas *canvas = matrix->CreateFrameCanvas();
+    // Canvases for the render thread; SwapOnVSync hands back the one
+    // that was on screen, so the pool gains the matrix's own canvas
+    CanvasQueue freeCanvases(FRAME_CANVASES + 1);
+    for (int i = 0; i < FRAME_CANVASES; i++) freeCanvases.push(matrix->CreateFrameCanvas());
+#else
+    // Headless build: render into memory, "vsync" paced to ~60 fps
+    std::cerr << "Headless build, rendering offscreen " << WIDTH << "x" << HEIGHT << "\n";
+    std::vector<MemoryCanvas> memoryCanvases(FRAME_CANVASES + 1, MemoryCanvas(WIDTH, HEIGHT));
+    CanvasQueue freeCanvases(FRAME_CANVASES + 1);
+    for (int i = 0; i < FRAME_CANVASES; i++) freeCanvases.push(&memoryCanvases[i]);
+    OutputCanvas* onScreen = &memoryCanvases[FRAME_CANVASES];
+    const auto framePeriod = std::chrono::microseconds(16667);
+    auto nextVsync = std::chrono::steady_clock::now();
+#endif
+    ReadyQueue readyFrames(FRAME_CANVASES);
+    pipeline.canvases.store(FRAME_CANVASES + 1);
+
+    // Render workers (created once, idle between frames)
+    RenderPool pool(renderThreads);
+    g_renderPool = &pool;
+    std::cerr << "Render threads: " << pool.threads() << "\n";
 
     // START AUDIO THREAD AFTER LED INIT
     std::cerr << "Starting audio...\n";
@@ -1497,43 +1266,45 @@ int main() {
     // Wait for audio to initialize
     std::this_thread::sleep_for(std::chrono::seconds(2));
 
-    auto t0 = std::chrono::steady_clock::now();
-    auto lastFrame = std::chrono::steady_clock::now();
+    // START RENDER THREAD (this thread presents)
+    std::thread renderT(renderThread, std::ref(freeCanvases), std::ref(readyFrames));
+    renderT.detach();
 
+    TRACE_THREAD("present");
     while (true) {
-        auto now = std::chrono::steady_clock::now();
-        float timeSec = std::chrono::duration<float>(now - t0).count();
-
-        // Calculate delta time since last frame
-        float dt = std::chrono::duration<float>(now - lastFrame).count();
-        lastFrame = now;
-        g_rawDeltaTime.store(dt);  // Raw time for timers (mode changes etc)
-        float speedMult = settings.animSpeed.load() / 100.0f;
-        g_deltaTime.store(dt * speedMult);  // Scaled time for animations
-
-        // Get settings
-        int br = settings.brightness.load();
-        int manualEffect = settings.currentEffect.load();
-
-        // Choose effect
-        int id;
-        bool loopEnabled = settings.autoLoop.load();
-        if (manualEffect >= 0 && manualEffect <= 12) {
-            // Manual effect selected - use it directly
-            id = manualEffect;
-        } else if (loopEnabled) {
-            // Auto mode with loop enabled - cycle through effects
-            id = autoEffect(timeSec);
-        } else {
-            // Auto mode with loop disabled - stay on effect 0
-            id = 0;
+        ReadyFrame f;
+        if (!readyFrames.tryPop(f)) {
+            // An empty queue while the governor holds frames back is pacing,
+            // not a stall; count only frames rendered free-running or late
+            if (!pipeline.paced.load(std::memory_order_relaxed))
+                pipeline.starved.fetch_add(1, std::memory_order_relaxed);
+            f = readyFrames.pop();
         }
+        pipeline.queueDepth.store((int)readyFrames.size());
 
-        renderEffect(id, canvas, timeSec, 255);  // Always render at full brightness
+        auto swapStart = std::chrono::steady_clock::now();
+        OutputCanvas* offScreen;
+        {
+            TRACE_SCOPE("SwapOnVSync");
+#ifndef HEADLESS
+            // Apply global brightness
+            matrix->SetBrightness(f.brightness * 100 / 255);  // SetBrightness takes 0-100
+
+            offScreen = matrix->SwapOnVSync(f.canvas);
+#else
+            nextVsync = std::max(nextVsync + framePeriod, swapStart);
+            std::this_thread::sleep_until(nextVsync);
+            offScreen = onScreen;
+            onScreen = f.canvas;
+#endif
+        }
+        auto swapped = std::chrono::steady_clock::now();
 
-        // Apply global brightness
-        matrix->SetBrightness(br * 100 / 255);  // SetBrightness takes 0-100
+        freeCanvases.push(offScreen);
 
-        canvas = matrix->SwapOnVSync(canvas);
+        smoothStat(pipeline.presentUs, elapsedUs(swapStart, swapped));
+        metrics.swapWaitUs.observe(elapsedUs(swapStart, swapped));
+        smoothStat(pipeline.latencyUs, elapsedUs(f.doneAt, swapped));
+        pipeline.frames.fetch_add(1, std::memory_order_relaxed);
     }
 }
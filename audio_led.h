@@ -0,0 +1,103 @@
+// ====================================================================
+//  SHARED STATE
+//  Settings, frame timing and the published audio analysis. Written by
+//  the web server and audio thread, read by the renderer.
+//  Definitions live in state.cpp.
+// ====================================================================
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include "seqlock.h"
+
+// ====================================================================
+// SETTINGS (adjustable via web)
+// ====================================================================
+static const int WIDTH  = 128;
+static const int HEIGHT = 64;
+static const int FFT_SIZE = 1024;  // analysis window length (samples)
+
+struct Settings {
+    std::atomic<int> effectDuration{5};      // seconds per effect
+    std::atomic<int> brightness{180};         // 0-255
+    std::atomic<float> noiseThreshold{0.1f}; // volume threshold
+    std::atomic<int> currentEffect{-1};       // -1 = auto, 0-10 = manual
+    std::atomic<float> sensitivity{4.0f};     // audio sensitivity multiplier (lower for line-in)
+    std::atomic<bool> autoLoop{true};         // true = cycle through effects
+    std::atomic<int> modeSpeed{4};            // seconds between Volume Bars mode changes
+    std::atomic<int> volumeMode{-1};          // Volume Bars sub-mode: -1 = rotate, 0-5 = fixed
+    std::atomic<int> animSpeed{100};          // animation speed percentage (10-200%)
+    std::atomic<int> hopSize{256};            // analysis hop in samples (FFT every hop, 64-FFT_SIZE)
+    std::atomic<int> window{1};               // analysis window: 0=rect, 1=Hann, 2=Blackman
+    std::atomic<int> targetFps{60};           // frame governor target, 0 = as fast as vsync allows
+    std::atomic<int> cpuBudget{100};          // max share of one core for rendering (10-100%)
+    std::atomic<int> renderScale{0};          // heavy effects: 0 = auto, 1/2/4 = fixed divisor
+    std::atomic<int> upscaleFilter{1};        // 0 = nearest, 1 = bilinear
+    std::atomic<int> transition{1};           // effect change: 0 = cut, 1 = crossfade, 2 = wipe
+    std::atomic<int> transitionMs{600};       // transition length
+    std::atomic<int> eventRate{30};           // /events messages per second (1-60)
+};
+
+extern Settings settings;
+
+// ====================================================================
+// GLOBAL TIMING
+// ====================================================================
+extern std::atomic<float> g_deltaTime;     // Time since last frame (with speed multiplier)
+extern std::atomic<float> g_rawDeltaTime;  // Raw time since last frame (for timers)
+
+// ====================================================================
+// SHARED AUDIO STATE
+// ====================================================================
+// One analysis result. Published as a unit so a reader never sees volume,
+// beat and spectrum from different analysis blocks.
+struct AudioFrame {
+    uint64_t seq = 0;          // increments with every analysis (0 = none yet)
+    int64_t captureNs = 0;     // steady_clock ns when the newest samples were read from ALSA
+    float volume = 0;
+    float beat = 0;
+    float spectrum[8] = {0};
+};
+
+struct AudioState {
+    SeqLock<AudioFrame> frame;  // written by the audio thread, lock-free for readers
+};
+
+extern AudioState audio;
+
+// Snapshot taken once per render frame; effects read only this
+extern AudioFrame g_audio;
+
+// Negotiated ALSA capture parameters (reported in /status)
+struct CaptureInfo {
+    std::atomic<bool> mmap{false};       // true = low-latency mmap mode active
+    std::atomic<int> rate{0};            // Hz
+    std::atomic<int> period{0};          // frames per period
+    std::atomic<int> bufferSize{0};      // frames in the ring buffer
+};
+
+extern CaptureInfo capture;
+
+// Render/present pipeline timings (reported in /status). Times are
+// smoothed over ~16 frames, in microseconds.
+struct PipelineInfo {
+    std::atomic<int> canvases{0};        // FrameCanvas buffers in the pool
+    std::atomic<int> queueDepth{0};      // finished frames waiting for vsync
+    std::atomic<float> renderUs{0};      // renderEffect()
+    std::atomic<float> blitUs{0};        // FrameBuffer -> canvas copy
+    std::atomic<float> presentUs{0};     // presenter blocked in SwapOnVSync
+    std::atomic<float> latencyUs{0};     // frame finished -> on screen
+    std::atomic<float> audioLatencyUs{0}; // samples captured -> frame that uses them starts
+    std::atomic<uint64_t> frames{0};     // frames presented
+    std::atomic<uint64_t> starved{0};    // presenter found no finished frame, render behind
+    std::atomic<bool> paced{false};      // governor slept before the frame in progress
+    std::atomic<float> achievedFps{0};   // measured render rate
+    std::atomic<float> frameBudgetUs{0}; // work allowed per frame by the governor
+    std::atomic<uint64_t> missed{0};     // frames started after their deadline
+    std::atomic<int> renderScale{1};     // divisor the last frame was rendered at
+    std::atomic<uint64_t> transitions{0};     // transitions started
+    std::atomic<uint64_t> transitionsCut{0};  // ended early: over the frame budget
+    std::atomic<int> activeEffect{-1};        // effect on screen (transition target)
+};
+
+extern PipelineInfo pipeline;
@@ -0,0 +1,294 @@
+// ====================================================================
+//  RENDER BENCHMARK
+//  Drives every effect (and every Volume Bars sub-mode) through an
+//  offscreen canvas with scripted audio and reports per-frame render
+//  time. Build and run with: make bench
+//
+//  Options:
+//    --frames=N   measured frames per case (default 600)
+//    --warmup=N   unmeasured frames before each case (default 60)
+//    --csv=FILE   CSV output (default bench.csv)
+//    --json=FILE  JSON output (default bench.json)
+//    --threads=L  comma-separated render thread counts to run every case
+//                 with (default "1,<cores>"); a speedup summary follows
+//    --scale=N    render the scalable effects at 1/N resolution (2 or 4)
+//                 plus a bilinear upscale (default 1 = full resolution)
+// ====================================================================
+
+#include "audio_led.h"
+#include "effects.h"
+#include "canvas.h"
+#include "render_pool.h"
+#include "scaler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const float FRAME_DT = 1.0f / 60.0f;                // simulated frame rate
+static const double FRAME_BUDGET_US = 1e6 / 60.0;          // for the "% of budget" column
+
+// ---------------------- Scripted audio ---------------------------
+enum Scenario { SCN_SILENCE, SCN_TONE, SCN_BEATS, SCN_NOISE, SCN_COUNT };
+static const char* SCENARIO_NAMES[SCN_COUNT] = { "silence", "tone", "beats", "noise" };
+
+// Deterministic so runs are comparable between builds
+static uint32_t rngState = 1;
+static float rnd() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return (rngState >> 8) * (1.0f / 16777216.0f);
+}
+
+// Audio features as the analysis thread would publish them for frame n.
+// Volume is ~0-1; band values use the analysis scale (~0-80, where the
+// spectrum effect draws a full-height bar).
+static AudioFrame scriptedAudio(Scenario s, int n) {
+    AudioFrame f;
+    f.seq = (uint64_t)n + 1;
+    switch (s) {
+        case SCN_SILENCE:
+            break;
+        case SCN_TONE:
+            // Steady mid-range sine: one strong band, leakage into neighbours
+            f.volume = 0.5f;
+            f.spectrum[3] = 40.0f;
+            f.spectrum[2] = f.spectrum[4] = 10.0f;
+            break;
+        case SCN_BEATS: {
+            // 120 BPM kick drum: bass bands spike every 30 frames and decay
+            float env = powf(0.85f, (float)(n % 30));
+            f.volume = 0.2f + 0.7f * env;
+            f.beat = env;
+            f.spectrum[0] = 90.0f * env;
+            f.spectrum[1] = 70.0f * env;
+            f.spectrum[2] = 40.0f * env;
+            for (int b = 3; b < 8; b++) f.spectrum[b] = 5.0f;
+            break;
+        }
+        case SCN_NOISE:
+            // White noise: every band busy, random beat triggers
+            f.volume = 0.5f + 0.2f * rnd();
+            f.beat = rnd() < 0.1f ? 1.0f : 0.0f;
+            for (int b = 0; b < 8; b++) f.spectrum[b] = 30.0f + 40.0f * rnd();
+            break;
+        default:
+            break;
+    }
+    return f;
+}
+
+// ---------------------- Measurement ------------------------------
+struct Result {
+    std::string name;
+    int effect;
+    int volumeMode;
+    Scenario scenario;
+    int threads;
+    int scale;
+    double meanUs, p50Us, p99Us, maxUs;
+};
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    size_t i = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[i];
+}
+
+// Times renderEffect() (plus the upscale when 'small' is given and the
+// effect is scalable) and the blit to the output canvas
+static Result runCase(FrameBuffer& fb, FrameBuffer* small, PixelCanvas* canvas, int effect,
+                      int volumeMode, Scenario scn, int warmup, int frames) {
+    if (!effectScalable(effect)) small = nullptr;
+
+    settings.volumeMode.store(volumeMode);
+    g_deltaTime.store(FRAME_DT);
+    g_rawDeltaTime.store(FRAME_DT);
+    rngState = 1;
+    srand(1);
+
+    std::vector<double> us;
+    us.reserve(frames);
+    for (int n = 0; n < warmup + frames; n++) {
+        float t = n * FRAME_DT;
+        g_audio = scriptedAudio(scn, n);
+
+        auto a = std::chrono::steady_clock::now();
+        if (small) {
+            renderEffect(effect, *small, t, 255);
+            upscaleFrame(*small, fb, UPSCALE_BILINEAR);
+        } else {
+            renderEffect(effect, fb, t, 255);
+        }
+        endEffectFrame();
+        canvas->Blit(fb);
+        auto b = std::chrono::steady_clock::now();
+
+        if (n >= warmup) us.push_back(std::chrono::duration<double, std::micro>(b - a).count());
+    }
+
+    Result r;
+    r.name = effectName(effect);
+    if (volumeMode >= 0) r.name += " #" + std::to_string(volumeMode);
+    r.effect = effect;
+    r.volumeMode = volumeMode;
+    r.scenario = scn;
+    r.threads = g_renderPool ? g_renderPool->threads() : 1;
+    r.scale = small ? fb.width() / small->width() : 1;
+
+    double sum = 0;
+    for (double v : us) sum += v;
+    std::sort(us.begin(), us.end());
+    r.meanUs = sum / us.size();
+    r.p50Us = percentile(us, 0.50);
+    r.p99Us = percentile(us, 0.99);
+    r.maxUs = us.back();
+    return r;
+}
+
+// ---------------------- Output -----------------------------------
+static bool writeCsv(const char* path, const std::vector<Result>& results) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "effect,volume_mode,name,scenario,threads,scale,mean_us,p50_us,p99_us,max_us\n");
+    for (const Result& r : results) {
+        fprintf(f, "%d,%d,\"%s\",%s,%d,%d,%.2f,%.2f,%.2f,%.2f\n", r.effect, r.volumeMode,
+                r.name.c_str(), SCENARIO_NAMES[r.scenario], r.threads, r.scale,
+                r.meanUs, r.p50Us, r.p99Us, r.maxUs);
+    }
+    fclose(f);
+    return true;
+}
+
+static bool writeJson(const char* path, const std::vector<Result>& results, int frames) {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+    fprintf(f, "{\"compiler\":\"%s\",\"fixed_point\":%s,\"frames\":%d,\"results\":[\n",
+            __VERSION__,
+#ifdef FIXED_POINT
+            "true",
+#else
+            "false",
+#endif
+            frames);
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        fprintf(f, "  {\"effect\":%d,\"volume_mode\":%d,\"name\":\"%s\",\"scenario\":\"%s\","
+                   "\"threads\":%d,\"scale\":%d,\"mean_us\":%.2f,\"p50_us\":%.2f,\"p99_us\":%.2f,"
+                   "\"max_us\":%.2f}%s\n",
+                r.effect, r.volumeMode, r.name.c_str(), SCENARIO_NAMES[r.scenario], r.threads, r.scale,
+                r.meanUs, r.p50Us, r.p99Us, r.maxUs, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(f, "]}\n");
+    fclose(f);
+    return true;
+}
+
+// Mean time per effect summed over scenarios, relative to the first
+// thread count in the list
+static void printScaling(const std::vector<Result>& results, const std::vector<int>& threadCounts) {
+    printf("\nScaling (total mean us over all scenarios, speedup vs %d thread%s)\n",
+           threadCounts[0], threadCounts[0] == 1 ? "" : "s");
+    printf("%-16s", "effect");
+    for (int t : threadCounts) printf(" %8dT", t);
+    printf("\n");
+
+    std::vector<std::string> names;
+    for (const Result& r : results)
+        if (std::find(names.begin(), names.end(), r.name) == names.end()) names.push_back(r.name);
+
+    for (const std::string& name : names) {
+        std::vector<double> total(threadCounts.size(), 0.0);
+        for (const Result& r : results) {
+            if (r.name != name) continue;
+            for (size_t i = 0; i < threadCounts.size(); i++)
+                if (r.threads == threadCounts[i]) total[i] += r.meanUs;
+        }
+        printf("%-16s %7.1f ", name.c_str(), total[0]);
+        for (size_t i = 1; i < threadCounts.size(); i++)
+            printf(" %7.2fx", total[i] > 0 ? total[0] / total[i] : 0.0);
+        printf("\n");
+    }
+}
+
+// ====================================================================
+// MAIN
+// ====================================================================
+int main(int argc, char** argv) {
+    int frames = 600;
+    int warmup = 60;
+    const char* csvPath = "bench.csv";
+    const char* jsonPath = "bench.json";
+    std::vector<int> threadCounts;
+    int scale = 1;
+
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--frames=", 9) == 0) {
+            frames = atoi(argv[i] + 9);
+        } else if (strncmp(argv[i], "--warmup=", 9) == 0) {
+            warmup = atoi(argv[i] + 9);
+        } else if (strncmp(argv[i], "--csv=", 6) == 0) {
+            csvPath = argv[i] + 6;
+        } else if (strncmp(argv[i], "--json=", 7) == 0) {
+            jsonPath = argv[i] + 7;
+        } else if (strncmp(argv[i], "--scale=", 8) == 0) {
+            scale = atoi(argv[i] + 8);
+        } else if (strncmp(argv[i], "--threads=", 10) == 0) {
+            for (const char* p = argv[i] + 10; *p; ) {
+                threadCounts.push_back(std::max(1, atoi(p)));
+                while (*p && *p != ',') p++;
+                if (*p == ',') p++;
+            }
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            fprintf(stderr, "Usage: %s [--frames=N] [--warmup=N] [--csv=FILE] [--json=FILE] [--threads=1,2,4] [--scale=1|2|4]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (frames < 1) frames = 1;
+    if (warmup < 0) warmup = 0;
+    if (threadCounts.empty()) {
+        threadCounts.push_back(1);
+        int cores = (int)std::thread::hardware_concurrency();
+        if (cores > 1) threadCounts.push_back(cores);
+    }
+
+    if (scale != 2 && scale != 4) scale = 1;
+    FrameBuffer frame(WIDTH, HEIGHT);
+    FrameBuffer reduced(WIDTH / scale, HEIGHT / scale);
+    FrameBuffer* small = scale > 1 ? &reduced : nullptr;
+    MemoryCanvas canvas(WIDTH, HEIGHT);
+    std::vector<Result> results;
+
+    printf("%-16s %-8s %3s %9s %9s %9s %9s %8s\n",
+           "effect", "audio", "thr", "mean us", "p50 us", "p99 us", "max us", "p99 %");
+    for (int threads : threadCounts) {
+        RenderPool pool(threads);
+        g_renderPool = &pool;
+        for (int e = 0; e < effectCount(); e++) {
+            // Volume Bars is benchmarked once per sub-mode
+            int modes = (e == 0) ? VOLUME_MODE_COUNT : 1;
+            for (int m = 0; m < modes; m++) {
+                for (int s = 0; s < SCN_COUNT; s++) {
+                    Result r = runCase(frame, small, &canvas, e, e == 0 ? m : -1, (Scenario)s, warmup, frames);
+                    printf("%-16s %-8s %3d %9.1f %9.1f %9.1f %9.1f %7.1f%%\n",
+                           r.name.c_str(), SCENARIO_NAMES[s], r.threads, r.meanUs, r.p50Us, r.p99Us,
+                           r.maxUs, 100.0 * r.p99Us / FRAME_BUDGET_US);
+                    results.push_back(r);
+                }
+            }
+        }
+        g_renderPool = nullptr;
+    }
+    if (threadCounts.size() > 1) printScaling(results, threadCounts);
+
+    if (!writeCsv(csvPath, results)) fprintf(stderr, "Could not write %s\n", csvPath);
+    if (!writeJson(jsonPath, results, frames)) fprintf(stderr, "Could not write %s\n", jsonPath);
+    printf("\nWrote %s and %s (budget: %.0f us/frame at 60 fps)\n", csvPath, jsonPath, FRAME_BUDGET_US);
+    return 0;
+}
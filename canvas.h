@@ -0,0 +1,79 @@
+// ====================================================================
+//  CANVAS
+//  Output target for finished frames. Effects draw into a FrameBuffer;
+//  Blit() then pushes the whole frame to one of two backends:
+//    MatrixCanvas (matrix_canvas.h) - forwards to an rgb-matrix FrameCanvas
+//    MemoryCanvas (below)           - offscreen RGB888 framebuffer, no
+//                                     hardware needed (headless / bench)
+// ====================================================================
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "framebuffer.h"
+
+// Same calls as the subset of rgb_matrix::Canvas we need, plus a bulk copy
+class PixelCanvas {
+public:
+    virtual ~PixelCanvas() {}
+    virtual int width() const = 0;
+    virtual int height() const = 0;
+    virtual void SetPixel(int x, int y, uint8_t r, uint8_t g, uint8_t b) = 0;
+    virtual void Clear() = 0;
+
+    // Copy a whole frame (top-left aligned, clipped to the canvas)
+    virtual void Blit(const FrameBuffer& fb) {
+        int bw = std::min(fb.width(), width());
+        int bh = std::min(fb.height(), height());
+        for (int y = 0; y < bh; y++) {
+            const uint32_t* src = fb.row(y);
+            for (int x = 0; x < bw; x++)
+                SetPixel(x, y, pixelR(src[x]), pixelG(src[x]), pixelB(src[x]));
+        }
+    }
+};
+
+// ---------------------- Offscreen framebuffer --------------------
+// Row-major, 3 bytes per pixel (R, G, B). Out-of-range pixels are
+// ignored, like on the matrix.
+class MemoryCanvas : public PixelCanvas {
+public:
+    MemoryCanvas(int w, int h) : w(w), h(h), rgb((size_t)w * h * 3, 0) {}
+
+    int width() const override { return w; }
+    int height() const override { return h; }
+
+    void SetPixel(int x, int y, uint8_t r, uint8_t g, uint8_t b) override {
+        if ((unsigned)x >= (unsigned)w || (unsigned)y >= (unsigned)h) return;
+        uint8_t* p = &rgb[((size_t)y * w + x) * 3];
+        p[0] = r;
+        p[1] = g;
+        p[2] = b;
+    }
+
+    void Clear() override { memset(rgb.data(), 0, rgb.size()); }
+
+    void Blit(const FrameBuffer& fb) override {
+        int bw = std::min(fb.width(), w);
+        int bh = std::min(fb.height(), h);
+        for (int y = 0; y < bh; y++) {
+            const uint32_t* src = fb.row(y);
+            uint8_t* dst = &rgb[(size_t)y * w * 3];
+            for (int x = 0; x < bw; x++) {
+                uint32_t c = src[x];
+                dst[0] = pixelR(c);
+                dst[1] = pixelG(c);
+                dst[2] = pixelB(c);
+                dst += 3;
+            }
+        }
+    }
+
+    const uint8_t* pixels() const { return rgb.data(); }
+    size_t size() const { return rgb.size(); }
+
+private:
+    int w, h;
+    std::vector<uint8_t> rgb;
+};
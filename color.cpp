@@ -0,0 +1,61 @@
+// ====================================================================
+//  COLOR TABLES (see color.h)
+// ====================================================================
+
+#include "color.h"
+#include "framebuffer.h"
+
+uint32_t hsvLut[HUE_STEPS][BRIGHT_STEPS];
+uint32_t paletteFire[256];
+uint32_t paletteRainbow[256];
+
+const uint32_t spectrumBandColors[8] = {
+    0xFF0000,  // red
+    0xFF8000,  // orange
+    0xFFFF00,  // yellow
+    0x00FF00,  // green
+    0x00FFFF,  // cyan
+    0x0000FF,  // blue
+    0x8000FF,  // purple
+    0xFF00FF,  // magenta
+};
+
+// Same six-sector conversion the effects used to do per pixel
+static void hueToRgb(float h, float& r, float& g, float& b) {
+    float hh = h * 6.0f;
+    int i = (int)hh;
+    float f = hh - i;
+    float q = 1.0f - f;
+    switch (i % 6) {
+        case 0: r = 1; g = f; b = 0; break;
+        case 1: r = q; g = 1; b = 0; break;
+        case 2: r = 0; g = 1; b = f; break;
+        case 3: r = 0; g = q; b = 1; break;
+        case 4: r = f; g = 0; b = 1; break;
+        default: r = 1; g = 0; b = q; break;
+    }
+}
+
+uint32_t hsvColorExact(float h, float bright) {
+    float r, g, b;
+    hueToRgb(h, r, g, b);
+    return packRGB((int)(r * bright), (int)(g * bright), (int)(b * bright));
+}
+
+// Tables are filled once at startup, before any effect runs
+static struct ColorTableInit {
+    ColorTableInit() {
+        for (int h = 0; h < HUE_STEPS; h++) {
+            float r, g, b;
+            hueToRgb((float)h / HUE_STEPS, r, g, b);
+            for (int l = 0; l < BRIGHT_STEPS; l++) {
+                float bright = l * 255.0f / (BRIGHT_STEPS - 1);
+                hsvLut[h][l] = packRGB((int)(r * bright), (int)(g * bright), (int)(b * bright));
+            }
+            paletteRainbow[h * 256 / HUE_STEPS] = hsvLut[h][BRIGHT_STEPS - 1];
+        }
+        for (int v = 0; v < 256; v++) {
+            paletteFire[v] = packRGB(v, v / 2, v / 8);
+        }
+    }
+} colorTableInit;
@@ -0,0 +1,46 @@
+// ====================================================================
+//  COLOR
+//  Precomputed color tables shared by all effects. Per-pixel color
+//  conversion is a table lookup returning a packed 0x00RRGGBB pixel
+//  (see framebuffer.h).
+// ====================================================================
+#pragma once
+
+#include <cstdint>
+
+static const int HUE_STEPS    = 256;  // hue resolution (one full turn)
+static const int BRIGHT_STEPS = 64;   // brightness levels, 0 = black, 63 = full
+
+// hsvLut[hue][level]: fully saturated hue at brightness level*255/63
+extern uint32_t hsvLut[HUE_STEPS][BRIGHT_STEPS];
+
+// Gradient palettes, 256 entries each
+extern uint32_t paletteFire[256];     // black -> red -> orange -> yellow (v, v/2, v/8)
+extern uint32_t paletteRainbow[256];  // full-brightness hue wheel
+
+// Fixed colors of the 8 spectrum bars, bass to treble
+extern const uint32_t spectrumBandColors[8];
+
+// Table index for hue h; wraps, so any h (including > 1) is valid
+static inline int hueIndex(float h) {
+    return (int)(h * HUE_STEPS) & (HUE_STEPS - 1);
+}
+
+// Fully saturated HSV color. h wraps every 1.0, bright is 0-255.
+static inline uint32_t hsvColor(float h, float bright) {
+    int level = (int)(bright * ((BRIGHT_STEPS - 1) / 255.0f) + 0.5f);
+    if (level < 0) level = 0;
+    if (level > BRIGHT_STEPS - 1) level = BRIGHT_STEPS - 1;
+    return hsvLut[hueIndex(h)][level];
+}
+
+// Same conversion computed exactly, for colors picked once per frame
+// (full-screen fills) where 64 brightness levels could show as steps
+uint32_t hsvColorExact(float h, float bright);
+
+// Multiply all channels of c by scale/256 (scale 0-256), two channels per multiply
+static inline uint32_t scaleColor(uint32_t c, uint32_t scale) {
+    uint32_t rb = ((c & 0xFF00FF) * scale >> 8) & 0xFF00FF;
+    uint32_t g  = ((c & 0x00FF00) * scale >> 8) & 0x00FF00;
+    return rb | g;
+}
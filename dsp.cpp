@@ -0,0 +1,341 @@
+// ====================================================================
+//  DSP KERNELS (see dsp.h)
+// ====================================================================
+
+#include "dsp.h"
+
+#include <cmath>
+#include <cstring>
+
+#if !defined(DSP_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define DSP_NEON 1
+#elif !defined(DSP_NO_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#define DSP_SSE2 1
+#endif
+
+const char* dsp_variant() {
+#if defined(DSP_NEON)
+    return "neon";
+#elif defined(DSP_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+#ifndef FIXED_POINT
+
+// ---------------------- int16 -> float ---------------------------
+void dsp_s16_to_float(float* dst, const int16_t* src, int n) {
+    const float scale = 1.0f / 32768.0f;
+    int i = 0;
+#if defined(DSP_NEON)
+    const float32x4_t vscale = vdupq_n_f32(scale);
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t v = vld1q_s16(src + i);
+        float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+        float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+        vst1q_f32(dst + i,     vmulq_f32(lo, vscale));
+        vst1q_f32(dst + i + 4, vmulq_f32(hi, vscale));
+    }
+#elif defined(DSP_SSE2)
+    const __m128 vscale = _mm_set1_ps(scale);
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        // Sign-extend by placing each sample in the top half and shifting down
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(dst + i,     _mm_mul_ps(_mm_cvtepi32_ps(lo), vscale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), vscale));
+    }
+#endif
+    for (; i < n; i++)
+        dst[i] = src[i] * scale;
+}
+
+// ---------------------- Sum of squares ---------------------------
+float dsp_sum_squares(const float* x, int n) {
+    float sum = 0;
+    int i = 0;
+#if defined(DSP_NEON)
+    float32x4_t acc = vdupq_n_f32(0);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vld1q_f32(x + i);
+        acc = vmlaq_f32(acc, v, v);
+    }
+    float32x2_t s2 = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    sum = vget_lane_f32(vpadd_f32(s2, s2), 0);
+#elif defined(DSP_SSE2)
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_loadu_ps(x + i);
+        acc = _mm_add_ps(acc, _mm_mul_ps(v, v));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < n; i++)
+        sum += x[i] * x[i];
+    return sum;
+}
+
+// ---------------------- Per-bin magnitude ------------------------
+void dsp_magnitude(float* dst, const kiss_fft_cpx* bins, int n) {
+    int i = 0;
+#if defined(DSP_NEON)
+    for (; i + 4 <= n; i += 4) {
+        float32x4x2_t c = vld2q_f32((const float*)(bins + i));  // de-interleave re/im
+        float32x4_t p = vmlaq_f32(vmulq_f32(c.val[0], c.val[0]), c.val[1], c.val[1]);
+#if defined(__aarch64__)
+        vst1q_f32(dst + i, vsqrtq_f32(p));
+#else
+        // ARMv7 has no vector sqrt: x * rsqrt(x), two Newton steps (~1e-6 rel).
+        // The tiny bias keeps rsqrt(0) finite so silent bins come out as 0.
+        p = vaddq_f32(p, vdupq_n_f32(1e-30f));
+        float32x4_t e = vrsqrteq_f32(p);
+        e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(p, e), e));
+        e = vmulq_f32(e, vrsqrtsq_f32(vmulq_f32(p, e), e));
+        vst1q_f32(dst + i, vmulq_f32(p, e));
+#endif
+    }
+#elif defined(DSP_SSE2)
+    for (; i + 4 <= n; i += 4) {
+        __m128 a = _mm_loadu_ps((const float*)(bins + i));      // r0 i0 r1 i1
+        __m128 b = _mm_loadu_ps((const float*)(bins + i + 2));  // r2 i2 r3 i3
+        __m128 re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 p = _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+        _mm_storeu_ps(dst + i, _mm_sqrt_ps(p));
+    }
+#endif
+    for (; i < n; i++)
+        dst[i] = std::sqrt(bins[i].r * bins[i].r + bins[i].i * bins[i].i);
+}
+
+// ---------------------- Sum --------------------------------------
+float dsp_sum(const float* x, int n) {
+    float sum = 0;
+    int i = 0;
+#if defined(DSP_NEON)
+    float32x4_t acc = vdupq_n_f32(0);
+    for (; i + 4 <= n; i += 4)
+        acc = vaddq_f32(acc, vld1q_f32(x + i));
+    float32x2_t s2 = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    sum = vget_lane_f32(vpadd_f32(s2, s2), 0);
+#elif defined(DSP_SSE2)
+    __m128 acc = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4)
+        acc = _mm_add_ps(acc, _mm_loadu_ps(x + i));
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#endif
+    for (; i < n; i++)
+        sum += x[i];
+    return sum;
+}
+
+// ---------------------- Multiply ---------------------------------
+void dsp_mul(float* dst, const float* a, const float* b, int n) {
+    int i = 0;
+#if defined(DSP_NEON)
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32(dst + i, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+#elif defined(DSP_SSE2)
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+#endif
+    for (; i < n; i++)
+        dst[i] = a[i] * b[i];
+}
+
+#else  // FIXED_POINT
+
+// ---------------------- Sum of squares (S16) ---------------------
+int64_t dsp_sum_squares_s16(const int16_t* x, int n) {
+    int64_t sum = 0;
+    int i = 0;
+#if defined(DSP_NEON)
+    int64x2_t acc = vdupq_n_s64(0);
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t v = vld1q_s16(x + i);
+        int32x4_t lo = vmull_s16(vget_low_s16(v), vget_low_s16(v));
+        int32x4_t hi = vmull_s16(vget_high_s16(v), vget_high_s16(v));
+        // Widen pairwise into 64-bit lanes right away; 32-bit would overflow
+        acc = vpadalq_s32(acc, lo);
+        acc = vpadalq_s32(acc, hi);
+    }
+    sum = vgetq_lane_s64(acc, 0) + vgetq_lane_s64(acc, 1);
+#elif defined(DSP_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(x + i));
+        // Pairwise x0*x0 + x1*x1; non-negative, so widen as unsigned
+        __m128i sq = _mm_madd_epi16(v, v);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(sq, zero));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(sq, zero));
+    }
+    int64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    sum = lanes[0] + lanes[1];
+#endif
+    for (; i < n; i++)
+        sum += (int32_t)x[i] * x[i];
+    return sum;
+}
+
+// ---------------------- Per-bin magnitude (Q15) ------------------
+// |z| ~= 0.961*max(|re|,|im|) + 0.398*min(|re|,|im|)  ->  (123*max + 51*min) >> 7
+void dsp_magnitude_q15(int32_t* dst, const kiss_fft_cpx* bins, int n) {
+    int i = 0;
+#if defined(DSP_NEON)
+    const int16x4_t alpha = vdup_n_s16(123);
+    const int16x4_t beta  = vdup_n_s16(51);
+    for (; i + 8 <= n; i += 8) {
+        int16x8x2_t c = vld2q_s16((const int16_t*)(bins + i));
+        int16x8_t re = vqabsq_s16(c.val[0]);
+        int16x8_t im = vqabsq_s16(c.val[1]);
+        int16x8_t mx = vmaxq_s16(re, im);
+        int16x8_t mn = vminq_s16(re, im);
+        int32x4_t lo = vmlal_s16(vmull_s16(vget_low_s16(mx), alpha), vget_low_s16(mn), beta);
+        int32x4_t hi = vmlal_s16(vmull_s16(vget_high_s16(mx), alpha), vget_high_s16(mn), beta);
+        vst1q_s32(dst + i,     vshrq_n_s32(lo, 7));
+        vst1q_s32(dst + i + 4, vshrq_n_s32(hi, 7));
+    }
+#elif defined(DSP_SSE2)
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(bins + i));  // one bin per 32-bit lane
+        __m128i re = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+        __m128i im = _mm_srai_epi32(v, 16);
+        __m128i sr = _mm_srai_epi32(re, 31);
+        __m128i si = _mm_srai_epi32(im, 31);
+        re = _mm_sub_epi32(_mm_xor_si128(re, sr), sr);
+        im = _mm_sub_epi32(_mm_xor_si128(im, si), si);
+        __m128i gt = _mm_cmpgt_epi32(re, im);
+        __m128i mx = _mm_or_si128(_mm_and_si128(gt, re), _mm_andnot_si128(gt, im));
+        __m128i mn = _mm_or_si128(_mm_and_si128(gt, im), _mm_andnot_si128(gt, re));
+        // No 32-bit multiply in SSE2: 123 = 128 - 4 - 1, 51 = 32 + 16 + 2 + 1
+        __m128i a = _mm_sub_epi32(_mm_sub_epi32(_mm_slli_epi32(mx, 7), _mm_slli_epi32(mx, 2)), mx);
+        __m128i b = _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(mn, 5), _mm_slli_epi32(mn, 4)),
+                                  _mm_add_epi32(_mm_slli_epi32(mn, 1), mn));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_srai_epi32(_mm_add_epi32(a, b), 7));
+    }
+#endif
+    for (; i < n; i++) {
+        int32_t re = bins[i].r < 0 ? -bins[i].r : bins[i].r;
+        int32_t im = bins[i].i < 0 ? -bins[i].i : bins[i].i;
+        int32_t mx = re > im ? re : im;
+        int32_t mn = re > im ? im : re;
+        dst[i] = (mx * 123 + mn * 51) >> 7;
+    }
+}
+
+// ---------------------- Sum (int32) ------------------------------
+int32_t dsp_sum_s32(const int32_t* x, int n) {
+    int32_t sum = 0;
+    int i = 0;
+#if defined(DSP_NEON)
+    int32x4_t acc = vdupq_n_s32(0);
+    for (; i + 4 <= n; i += 4)
+        acc = vaddq_s32(acc, vld1q_s32(x + i));
+    int32x2_t s2 = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+    sum = vget_lane_s32(vpadd_s32(s2, s2), 0);
+#elif defined(DSP_SSE2)
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 4 <= n; i += 4)
+        acc = _mm_add_epi32(acc, _mm_loadu_si128((const __m128i*)(x + i)));
+    int32_t lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; i < n; i++)
+        sum += x[i];
+    return sum;
+}
+
+// ---------------------- Multiply (Q15) ---------------------------
+void dsp_mul_q15(int16_t* dst, const int16_t* a, const int16_t* b, int n) {
+    int i = 0;
+#if defined(DSP_NEON)
+    for (; i + 8 <= n; i += 8)
+        vst1q_s16(dst + i, vqrdmulhq_s16(vld1q_s16(a + i), vld1q_s16(b + i)));
+#elif defined(DSP_SSE2)
+    const __m128i round = _mm_set1_epi32(1 << 14);
+    for (; i + 8 <= n; i += 8) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        __m128i lo = _mm_mullo_epi16(va, vb);
+        __m128i hi = _mm_mulhi_epi16(va, vb);
+        __m128i p0 = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), round), 15);
+        __m128i p1 = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), round), 15);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(p0, p1));
+    }
+#endif
+    for (; i < n; i++)
+        dst[i] = (int16_t)(((int32_t)a[i] * b[i] + (1 << 14)) >> 15);
+}
+
+#endif  // FIXED_POINT
+
+// ====================================================================
+// SLIDING WINDOW
+// ====================================================================
+SlidingWindow::SlidingWindow(int n)
+    : n(n), ring(2 * n, 0), window(n, 0) {
+    setWindow(WINDOW_HANN);
+}
+
+void SlidingWindow::setWindow(int t) {
+    if (t < WINDOW_RECT || t > WINDOW_BLACKMAN) t = WINDOW_HANN;
+    if (t == type) return;
+    type = t;
+
+    // Periodic windows (the usual choice for spectral analysis)
+    const double pi = 3.14159265358979323846;
+    double sum = 0;
+    for (int i = 0; i < n; i++) {
+        double ph = 2.0 * pi * i / n;
+        double w;
+        switch (type) {
+            case WINDOW_RECT:     w = 1.0; break;
+            case WINDOW_BLACKMAN: w = 0.42 - 0.5 * cos(ph) + 0.08 * cos(2 * ph); break;
+            default:              w = 0.5 - 0.5 * cos(ph); break;
+        }
+        sum += w;
+#ifdef FIXED_POINT
+        window[i] = (int16_t)floor(0.5 + w * 32767);
+#else
+        window[i] = (float)w;
+#endif
+    }
+    windowGain = (float)(n / sum);
+}
+
+void SlidingWindow::push(const int16_t* src, int count) {
+    while (count > 0) {
+        int chunk = n - head;
+        if (chunk > count) chunk = count;
+#ifdef FIXED_POINT
+        memcpy(&ring[head], src, chunk * sizeof(int16_t));
+#else
+        dsp_s16_to_float(&ring[head], src, chunk);
+#endif
+        memcpy(&ring[head + n], &ring[head], chunk * sizeof(kiss_fft_scalar));
+        head += chunk;
+        if (head == n) head = 0;
+        src += chunk;
+        count -= chunk;
+    }
+}
+
+void SlidingWindow::apply(kiss_fft_scalar* dst) const {
+#ifdef FIXED_POINT
+    dsp_mul_q15(dst, latest(), window.data(), n);
+#else
+    dsp_mul(dst, latest(), window.data(), n);
+#endif
+}
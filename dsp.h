@@ -0,0 +1,78 @@
+// ====================================================================
+//  DSP KERNELS
+//  Hot loops of the audio analysis path, vectorized per platform:
+//  NEON (Pi 2/3/4/5), SSE2 (x86 dev hosts), scalar fallback (Pi Zero).
+//  The variant is picked at compile time; -DDSP_NO_SIMD forces scalar.
+// ====================================================================
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "kissfft/kiss_fft.h"
+
+// Name of the compiled-in kernel variant ("neon", "sse2" or "scalar")
+const char* dsp_variant();
+
+#ifndef FIXED_POINT
+// dst[i] = src[i] / 32768
+void dsp_s16_to_float(float* dst, const int16_t* src, int n);
+
+// Sum of x[i]^2
+float dsp_sum_squares(const float* x, int n);
+
+// dst[i] = |bins[i]|
+void dsp_magnitude(float* dst, const kiss_fft_cpx* bins, int n);
+
+// Sum of x[i]
+float dsp_sum(const float* x, int n);
+
+// dst[i] = a[i] * b[i]
+void dsp_mul(float* dst, const float* a, const float* b, int n);
+#else
+// Sum of x[i]^2 over raw S16 samples (exact)
+int64_t dsp_sum_squares_s16(const int16_t* x, int n);
+
+// dst[i] ~= |bins[i]| for Q15 bins (alpha-max-plus-beta-min, error < 4%)
+void dsp_magnitude_q15(int32_t* dst, const kiss_fft_cpx* bins, int n);
+
+// Sum of x[i]
+int32_t dsp_sum_s32(const int32_t* x, int n);
+
+// dst[i] = a[i] * b[i] in Q15, rounded
+void dsp_mul_q15(int16_t* dst, const int16_t* a, const int16_t* b, int n);
+#endif
+
+// ---------------------- Sliding analysis window ------------------
+enum WindowType { WINDOW_RECT = 0, WINDOW_HANN = 1, WINDOW_BLACKMAN = 2 };
+
+// Holds the newest N samples for an overlapping STFT. Every sample is
+// stored twice (ring of 2N) so the last N are always contiguous and can be
+// handed to the vector kernels without unwrapping.
+struct SlidingWindow {
+    explicit SlidingWindow(int n);
+
+    // Rebuilds the window table only when the type changes
+    void setWindow(int type);
+
+    // Append the newest samples (count <= N), converting to kiss_fft_scalar
+    void push(const int16_t* src, int count);
+
+    // Last N samples, oldest first
+    const kiss_fft_scalar* latest() const { return ring.data() + head; }
+
+    // dst = latest() * window
+    void apply(kiss_fft_scalar* dst) const;
+
+    // 1 / coherent gain of the window: multiplying band energies by this
+    // keeps tonal levels equal to the unwindowed analysis
+    float gain() const { return windowGain; }
+    int windowType() const { return type; }
+
+    int n;
+private:
+    std::vector<kiss_fft_scalar> ring;
+    std::vector<kiss_fft_scalar> window;
+    int head = 0;
+    int type = -1;
+    float windowGain = 1.0f;
+};
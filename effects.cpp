@@ -0,0 +1,1045 @@
+// ====================================================================
+//  EFFECTS (see effects.h)
+// ====================================================================
+
+#include "effects.h"
+#include "audio_led.h"
+#include "color.h"
+#include "raster.h"
+#include "render_pool.h"
+#include "trace.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <memory>
+
+// ====================================================================
+// EFFECTS
+// ====================================================================
+// Effects that shade every pixel independently split the frame into
+// bands of RENDER_BAND rows with parallelRows() (render_pool.h)
+static const int RENDER_BAND = 8;
+
+// Effects that support reduced render resolution (effectScalable) draw at
+// fb.width() x fb.height() and multiply their pixel sizes by this factor
+static inline float renderScaleOf(const FrameBuffer &fb) {
+    return (float)fb.width() / WIDTH;
+}
+
+// ---------------------- Volume Bars ------------------------------
+class VolumeEffect : public Effect {
+public:
+    void reset() override {
+        mode = 0;
+        modeTimer = 0;
+        hue = 0;
+        angle = 0;
+    }
+    void render(FrameBuffer &fb, float t, int br) override;
+
+private:
+    int mode;
+    float modeTimer;
+    float hue;
+    float angle;  // triangle rotation (mode 1)
+};
+
+void VolumeEffect::render(FrameBuffer &fb, float t, int br) {
+    const int W = fb.width(), H = fb.height();
+    const float k = renderScaleOf(fb);
+
+    float vol = g_audio.volume;
+    float beat = g_audio.beat;
+    float threshold = settings.noiseThreshold.load();
+    float dt = g_deltaTime.load();
+    float rawDt = g_rawDeltaTime.load();
+
+    if (vol < threshold) vol = 0;
+
+    // Change mode based on modeSpeed setting (uses raw time, not affected by animation speed)
+    int fixedMode = settings.volumeMode.load();
+    if (fixedMode >= 0 && fixedMode < VOLUME_MODE_COUNT) {
+        mode = fixedMode;
+    } else {
+        int modeSpeedSec = settings.modeSpeed.load();
+        modeTimer += rawDt;
+        if (modeTimer > (float)modeSpeedSec) {
+            mode = (mode + 1) % VOLUME_MODE_COUNT;
+            modeTimer = 0;
+        }
+    }
+
+    // Slowly rotate hue (using deltaTime - affected by animation speed)
+    hue += 0.3f * dt;  // ~0.3 per second
+    if (hue > 1.0f) hue -= 1.0f;
+
+
+    // Clear screen
+    fb.clear();
+
+    int h = (int)(vol * 80 * k);
+    if (h > H) h = H;
+
+    switch(mode) {
+        case 0: {
+            // Centered expanding bars
+            int barWidth = (int)(((int)(vol * 60) + 4) * k);
+            if (barWidth > W/2) barWidth = W/2;
+            int cx = W/2;
+            for (int y = H - h; y < H; y++) {
+                float yf = (float)(y - (H-h)) / (h > 0 ? h : 1);
+                fb.hline(cx - barWidth, cx + barWidth, y, hsvColor(hue + yf * 0.3f, br));
+            }
+            break;
+        }
+        case 1: {
+            // Rotating triangle
+            angle += (2.0f + vol * 6.0f) * dt;  // Rotation speed based on volume (using deltaTime)
+
+            int cx = W / 2;
+            int cy = H / 2;
+            float size = (15.0f + vol * 40.0f) * k;  // Triangle size based on volume
+
+            // 3 triangle vertices
+            float angles[3] = {angle, angle + 2.094f, angle + 4.189f};  // 120 degrees apart
+            int px[3], py[3];
+            for (int i = 0; i < 3; i++) {
+                px[i] = cx + (int)(cos(angles[i]) * size);
+                py[i] = cy + (int)(sin(angles[i]) * size * 0.5f);  // Squash for aspect ratio
+            }
+
+            // Filled triangle, shaded by distance from the center
+            auto shade = [&](uint32_t* row, int y, int x0, int x1) {
+                for (int x = x0; x < x1; x++) {
+                    float dist = rasterDistance(x - cx, y - cy);
+                    float f = 1.0f - dist / (size + 1);
+                    if (f < 0.3f) f = 0.3f;
+                    row[x] = hsvColor(hue + dist / k * 0.01f, br * f);
+                }
+            };
+            parallelRows(H, RENDER_BAND, [&](int y0, int y1) {
+                rasterTriangle(fb, px[0], py[0], px[1], py[1], px[2], py[2], shade, RowRange(y0, y1));
+            });
+            break;
+        }
+        case 2: {
+            // Diamond shape
+            int size = (int)(((int)(vol * 50) + 5) * k);
+            int cx = W/2, cy = H/2;
+            auto shade = [&](uint32_t* row, int y, int x0, int x1) {
+                int dy = abs(y - cy);
+                for (int x = x0; x < x1; x++) {
+                    int dist = abs(x - cx) + dy;
+                    float f = 1.0f - (float)dist / size;
+                    row[x] = hsvColor(hue + f * 0.2f, br * f);
+                }
+            };
+            parallelRows(H, RENDER_BAND, [&](int y0, int y1) {
+                rasterDiamond(fb, cx, cy, size, shade, RowRange(y0, y1));
+            });
+            break;
+        }
+        case 3: {
+            // Horizontal mirrored bars (top and bottom)
+            int barH = h / 2;
+            for (int y = 0; y < barH; y++) {
+                float yf = (float)y / (barH > 0 ? barH : 1);
+                uint32_t col = hsvColor(hue + yf * 0.2f, br * (1.0f - yf * 0.5f));
+                fb.hline(0, W, y, col);
+                fb.hline(0, W, H - 1 - y, col);
+            }
+            break;
+        }
+        case 4: {
+            // Corner triangles
+            // Distance to the nearest corner is min(x, W-x) + min(y, H-y),
+            // so each row has a run from the left edge and one from the right
+            int size = (int)(((int)(vol * 60) + 5) * k);
+            auto shade = [&](uint32_t* row, int y, int x0, int x1) {
+                int dy = std::min(y, H - y);
+                for (int x = x0; x < x1; x++) {
+                    int dist = std::min(x, W - x) + dy;
+                    float f = 1.0f - (float)dist / size;
+                    row[x] = hsvColor(hue + f * 0.3f, br * f);
+                }
+            };
+            parallelRows(H, RENDER_BAND, [&](int y0, int y1) {
+                for (int y = y0; y < y1; y++) {
+                    int run = size - std::min(y, H - y);  // covered where min(x, W-x) < run
+                    if (run <= 0) continue;
+                    if (2 * run > W) {
+                        rasterSpan(fb, y, 0, W, shade);
+                    } else {
+                        rasterSpan(fb, y, 0, run, shade);
+                        rasterSpan(fb, y, W - run + 1, W, shade);
+                    }
+                }
+            });
+            break;
+        }
+        case 5: {
+            // Concentric rings
+            // Every other 8-pixel ring (at full resolution), out to maxRad
+            int cx = W/2, cy = H/2;
+            float ringW = 8 * k;
+            float maxRad = (float)((int)(vol * 50) + 10) * k;
+            parallelRows(H, RENDER_BAND, [&](int y0, int y1) {
+                for (int ring = 0; ring * ringW < maxRad; ring += 2) {
+                    float ringHue = hue + ring * 0.15f;
+                    float outer = std::min((ring + 1) * ringW, maxRad);
+                    rasterAnnulus(fb, cx, cy, ring * ringW, outer,
+                                  [&](uint32_t* row, int y, int x0, int x1) {
+                        for (int x = x0; x < x1; x++) {
+                            float f = 1.0f - rasterDistance(x - cx, y - cy) / maxRad;
+                            row[x] = hsvColor(ringHue, br * f);
+                        }
+                    }, RowRange(y0, y1));
+                }
+            });
+            break;
+        }
+    }
+}
+
+// ---------------------- Beat Pulse -------------------------------
+class BeatEffect : public Effect {
+public:
+    void reset() override { hue = 0; }
+    void render(FrameBuffer &fb, float t, int br) override;
+
+private:
+    float hue;
+};
+
+void BeatEffect::render(FrameBuffer &fb, float t, int br) {
+
+    float beat = g_audio.beat;
+    float vol = g_audio.volume;
+    float threshold = settings.noiseThreshold.load();
+    float dt = g_deltaTime.load();
+
+    // Slowly cycle hue (using deltaTime)
+    hue += 0.2f * dt;  // ~0.2 per second
+    if (hue > 1.0f) hue -= 1.0f;
+
+
+    // Clear entire screen to black first
+    fb.clear();
+
+    // Only draw if above noise threshold
+    if (vol < threshold && beat < threshold) {
+        return;  // stay black
+    }
+
+    // Radius based on beat and volume
+    float radius = beat * 50.0f + vol * 30.0f;
+    if (radius < 5.0f) return;
+    if (radius > 70) radius = 70;
+
+    int cx = WIDTH/2;
+    int cy = HEIGHT/2;
+
+    // Draw circle with cycling color
+    rasterDisc(fb, cx, cy, radius, [&](uint32_t* row, int y, int x0, int x1) {
+        for (int x = x0; x < x1; x++) {
+            float d = rasterDistance(x - cx, y - cy);
+            float f = 1.0f - d/radius;
+            row[x] = hsvColor(hue + d * 0.005f, br * f);
+        }
+    });
+
+    // Draw frequency wave line through the middle
+    const float* spec = g_audio.spectrum;
+
+    // Complementary color for line (opposite hue)
+    float lineHue = hue + 0.5f;
+    if (lineHue > 1.0f) lineHue -= 1.0f;
+
+    // Draw a continuous wave line based on spectrum
+    for (int x = 0; x < WIDTH; x++) {
+        // Interpolate between spectrum bands
+        float bandPos = (float)x / WIDTH * 7.0f;
+        int band1 = (int)bandPos;
+        int band2 = band1 + 1;
+        if (band2 > 7) band2 = 7;
+        float frac = bandPos - band1;
+
+        float val = spec[band1] * (1.0f - frac) + spec[band2] * frac;
+        if (val < threshold) val = 0;
+
+        int offset = (int)(val * 0.3f);
+        if (offset > 20) offset = 20;
+
+        // Line color shifts slightly across width
+        uint32_t lineColor = hsvColor(lineHue + (float)x / WIDTH * 0.2f, br);
+
+        // Draw vertical line segment (wave thickness)
+        for (int dy = -1; dy <= 1; dy++) {
+            int y = cy + offset + dy;
+            if (y >= 0 && y < HEIGHT) {
+                fb.set(x, y, lineColor);
+            }
+            y = cy - offset + dy;
+            if (y >= 0 && y < HEIGHT) {
+                fb.set(x, y, lineColor);
+            }
+        }
+    }
+}
+
+// ---------------------- Spectrum Bars ----------------------------
+class SpectrumEffect : public Effect {
+public:
+    void reset() override { std::fill(smoothSpec, smoothSpec + 8, 0.0f); }
+    void render(FrameBuffer &fb, float t, int br) override;
+
+private:
+    float smoothSpec[8];  // fast attack, slow decay
+};
+
+void SpectrumEffect::render(FrameBuffer &fb, float t, int br) {
+    const int bands = 8;
+    int bw = WIDTH / bands;
+
+    // Smooth spectrum values
+    for (int i = 0; i < 8; i++) {
+        float target = g_audio.spectrum[i];
+        // Smooth: fast attack, slow decay
+        if (target > smoothSpec[i]) {
+            smoothSpec[i] = target;
+        } else {
+            smoothSpec[i] = smoothSpec[i] * 0.85f + target * 0.15f;
+        }
+    }
+
+    float threshold = settings.noiseThreshold.load();
+
+    // Black background (gaps and the space above each bar)
+    fb.clear();
+
+    for (int b = 0; b < bands; b++) {
+        float val = smoothSpec[b];
+
+        // Noise threshold
+        if (val < threshold) val = 0;
+
+        int h = (int)(val * 0.8f);
+        if (h > HEIGHT) h = HEIGHT;
+
+        int startX = b * bw + 2;
+        int endX = (b + 1) * bw - 2;
+
+        // Bar grows up from the bottom
+        if (h > 0) fb.fillRect(startX, HEIGHT - h, endX, HEIGHT, spectrumBandColors[b]);
+    }
+}
+
+// ---------------------- Plasma ----------------------------------
+// v(x,y) = sin(x*0.09 + t) + sin(y*0.08 + t*1.4) + sin((x+y)*0.04 + t*0.8)
+// The three terms depend only on the column, the row and the diagonal, so
+// they are evaluated once per frame (W + H + W+H-1 sinf calls instead of
+// 3 per pixel). v is kept in fixed-point angle units (PLASMA_ONE = 2*pi)
+// and the three color stages sin(k*v + offset) read a 1024-entry table.
+static const int PLASMA_ONE = 65536;                    // one full turn
+static const float PLASMA_RAD = PLASMA_ONE / 6.2831853f; // units per radian
+static const int PLASMA_SINE_BITS = 10;
+
+struct PlasmaFrame {
+    int32_t col[WIDTH];                 // sin(x*0.09 + t)
+    int32_t row[HEIGHT];                // sin(y*0.08 + t*1.4)
+    int32_t diag[WIDTH + HEIGHT - 1];   // sin((x+y)*0.04 + t*0.8)
+    int32_t offR, offG, offB;           // per-frame phase of each color stage
+    uint8_t lutR[1 << PLASMA_SINE_BITS];  // (sin*0.5+0.5) * br
+    uint8_t sine[1 << PLASMA_SINE_BITS];  // (sin*0.5+0.5) * 255 over one turn
+};
+
+static int32_t plasmaAngle(float radians) {
+    return (int32_t)lrintf(radians * PLASMA_RAD);
+}
+
+// Phase offsets only matter modulo one turn; wrap them so they stay small
+static int32_t plasmaPhase(float radians) {
+    return (int32_t)((int64_t)llrintf(fmodf(radians, 6.2831853f) * PLASMA_RAD) & (PLASMA_ONE - 1));
+}
+
+static void plasmaRows(FrameBuffer &fb, const PlasmaFrame &pf, int y0, int y1) {
+    const int SHIFT = 16 - PLASMA_SINE_BITS;
+    const int32_t MASK = (1 << PLASMA_SINE_BITS) - 1;
+    const int W = fb.width();
+    uint16_t ir[WIDTH], ig[WIDTH], ib[WIDTH];
+
+    for (int y = y0; y < y1; y++) {
+        const int32_t rowTerm = pf.row[y];
+        const int32_t* diag = pf.diag + y;
+
+        // Pure integer add/multiply/shift: auto-vectorizes (NEON, SSE)
+        for (int x = 0; x < W; x++) {
+            int32_t v = pf.col[x] + rowTerm + diag[x];
+            ir[x] = (uint16_t)(((v + pf.offR) >> SHIFT) & MASK);
+            ig[x] = (uint16_t)(((((v * 1331) >> 10) + pf.offG) >> SHIFT) & MASK);  // v * 1.3
+            ib[x] = (uint16_t)(((((v * 2355) >> 10) + pf.offB) >> SHIFT) & MASK);  // v * 2.3
+        }
+
+        uint32_t* out = fb.row(y);
+        for (int x = 0; x < W; x++) {
+            out[x] = ((uint32_t)pf.lutR[ir[x]] << 16) |
+                     ((uint32_t)pf.sine[ig[x]] << 8) |
+                     pf.sine[ib[x]];
+        }
+    }
+}
+
+class PlasmaEffect : public Effect {
+public:
+    void init() override {
+        for (int i = 0; i < (1 << PLASMA_SINE_BITS); i++)
+            pf.sine[i] = (uint8_t)((sinf(i * 6.2831853f / (1 << PLASMA_SINE_BITS)) * 0.5f + 0.5f) * 255);
+        lutBrightness = -1;
+    }
+    void render(FrameBuffer &fb, float t, int br) override;
+
+private:
+    PlasmaFrame pf;
+    int lutBrightness;  // brightness pf.lutR was built for
+};
+
+void PlasmaEffect::render(FrameBuffer &fb, float t, int br) {
+    if (br != lutBrightness) {
+        for (int i = 0; i < (1 << PLASMA_SINE_BITS); i++)
+            pf.lutR[i] = (uint8_t)((sinf(i * 6.2831853f / (1 << PLASMA_SINE_BITS)) * 0.5f + 0.5f) * br);
+        lutBrightness = br;
+    }
+
+    float vol = g_audio.volume;
+    float threshold = settings.noiseThreshold.load();
+    if (vol < threshold) vol = 0;
+    vol *= 6.0f;
+
+    // x and y are in full-resolution pixels when rendering scaled down
+    const int W = fb.width(), H = fb.height();
+    // Each pixel covers 'step' full-resolution pixels; sample at its center
+    const float step = 1.0f / renderScaleOf(fb);
+    const float c = (step - 1) * 0.5f;
+    for (int x = 0; x < W; x++) pf.col[x] = plasmaAngle(sinf((x*step + c)*0.09f + t));
+    for (int y = 0; y < H; y++) pf.row[y] = plasmaAngle(sinf((y*step + c)*0.08f + t*1.4f));
+    for (int d = 0; d < W + H - 1; d++) pf.diag[d] = plasmaAngle(sinf((d*step + 2*c)*0.04f + t*0.8f));
+
+    pf.offR = plasmaPhase(t*0.5f + vol);
+    pf.offG = plasmaPhase(t + vol*0.5f);
+    pf.offB = plasmaPhase(t*0.2f);
+
+    parallelRows(H, RENDER_BAND, [&](int y0, int y1) { plasmaRows(fb, pf, y0, y1); });
+}
+
+// ---------------------- Fire -------------------------------------
+class FireEffect : public Effect {
+public:
+    void reset() override { memset(fire, 0, sizeof(fire)); }
+    void render(FrameBuffer &fb, float t, int br) override;
+
+private:
+    int fire[HEIGHT][WIDTH];  // heat per pixel
+};
+
+void FireEffect::render(FrameBuffer &fb, float t, int br) {
+
+    // shift upward
+    for (int y = 0; y < HEIGHT-1; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            fire[y][x] = fire[y+1][x];
+        }
+    }
+
+    // Heat from audio volume
+    float vol = g_audio.volume;
+    float threshold = settings.noiseThreshold.load();
+    if (vol < threshold) vol = 0;
+    int heat = (int)(vol * 300);
+    if (heat > 255) heat = 255;
+
+    // Add heat at bottom with some randomness
+    for (int x = 0; x < WIDTH; x++) {
+        fire[HEIGHT-1][x] = heat + (rand() % 30) - 15;
+        if (fire[HEIGHT-1][x] < 0) fire[HEIGHT-1][x] = 0;
+        if (fire[HEIGHT-1][x] > 255) fire[HEIGHT-1][x] = 255;
+    }
+
+    // blur/cool
+    for (int y = 0; y < HEIGHT-1; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            int sum = fire[y][x];
+            if (x > 0) sum += fire[y][x-1];
+            if (x < WIDTH-1) sum += fire[y][x+1];
+            if (y < HEIGHT-1) sum += fire[y+1][x];
+            fire[y][x] = (sum / 4) - 2;
+            if (fire[y][x] < 0) fire[y][x] = 0;
+        }
+    }
+
+    // draw with fire colors
+    for (int y = 0; y < HEIGHT; y++) {
+        uint32_t* row = fb.row(y);
+        for (int x = 0; x < WIDTH; x++) {
+            row[x] = paletteFire[fire[y][x]];
+        }
+    }
+}
+
+// ---------------------- Raindrops --------------------------------
+class RainEffect : public Effect {
+public:
+    void reset() override {
+        for (int i = 0; i < 32; i++) {
+            drops[i][0] = rand() % WIDTH;
+            drops[i][1] = rand() % HEIGHT;
+        }
+    }
+    void render(FrameBuffer &fb, float t, int br) override;
+
+private:
+    float drops[32][2];  // x, y positions
+};
+
+void RainEffect::render(FrameBuffer &fb, float t, int br) {
+
+    float vol = g_audio.volume;
+    float threshold = settings.noiseThreshold.load();
+    if (vol < threshold) vol = 0;
+
+    // Clear
+    fb.clear();
+
+    // Move and draw drops (using deltaTime for consistent speed)
+    float dt = g_deltaTime.load();
+    float speed = (10.0f + vol * 50.0f) * dt;  // pixels per second * dt
+    for (int i = 0; i < 32; i++) {
+        drops[i][1] += speed;
+        if (drops[i][1] >= HEIGHT) {
+            drops[i][1] = 0;
+            drops[i][0] = rand() % WIDTH;
+        }
+
+        int x = (int)drops[i][0];
+        int y = (int)drops[i][1];
+
+        // Draw drop with tail
+        for (int ty = 0; ty < 5; ty++) {
+            int py = y - ty;
+            if (py >= 0 && py < HEIGHT) {
+                int intensity = br * (5 - ty) / 5;
+                fb.set(x, py, 0, intensity / 2, intensity);
+            }
+        }
+    }
+}
+
+// ---------------------- Matrix Rain ------------------------------
+class MatrixEffect : public Effect {
+public:
+    void reset() override {
+        for (int i = 0; i < WIDTH; i++) {
+            columns[i] = rand() % HEIGHT;
+            speeds[i] = 1 + rand() % 3;
+            columnPos[i] = 0;
+        }
+    }
+    void render(FrameBuffer &fb, float t, int br) override;
+
+private:
+    int columns[WIDTH];
+    int speeds[WIDTH];
+    float columnPos[WIDTH];
+};
+
+void MatrixEffect::render(FrameBuffer &fb, float t, int br) {
+
+    float vol = g_audio.volume;
+    float threshold = settings.noiseThreshold.load();
+    if (vol < threshold) vol = 0;
+
+    // Fade existing pixels
+    fb.clear();
+
+    // Update and draw columns (using deltaTime for consistent speed)
+    float dt = g_deltaTime.load();
+    float baseSpeed = 3.0f + vol * 10.0f;  // Base speed in pixels per second
+    for (int x = 0; x < WIDTH; x += 2) {
+        columnPos[x] += (speeds[x] * 1.5f + baseSpeed) * dt;
+        columns[x] = (int)columnPos[x];
+        if (columns[x] >= HEIGHT + 15) {
+            columnPos[x] = 0;
+            columns[x] = 0;
+            speeds[x] = 1 + rand() % 3;
+        }
+
+        // Draw falling trail
+        for (int i = 0; i < 15; i++) {
+            int y = columns[x] - i;
+            if (y >= 0 && y < HEIGHT) {
+                int g = br * (15 - i) / 15;
+                fb.set(x, y, g / 4, g, g / 4);
+            }
+        }
+    }
+}
+
+// ---------------------- Starfield --------------------------------
+class StarsEffect : public Effect {
+public:
+    void reset() override {
+        for (int i = 0; i < 64; i++) {
+            stars[i][0] = (rand() % WIDTH) - WIDTH/2;
+            stars[i][1] = (rand() % HEIGHT) - HEIGHT/2;
+            stars[i][2] = 1 + rand() % 10;
+        }
+    }
+    void render(FrameBuffer &fb, float t, int br) override;
+
+private:
+    float stars[64][3];  // x, y, z
+};
+
+void StarsEffect::render(FrameBuffer &fb, float t, int br) {
+
+    float vol = g_audio.volume;
+    float threshold = settings.noiseThreshold.load();
+    if (vol < threshold) vol = 0;
+
+    // Clear
+    fb.clear();
+
+    // Using deltaTime for consistent speed
+    float dt = g_deltaTime.load();
+    float speed = (5.0f + vol * 20.0f) * dt;  // units per second * dt
+
+    for (int i = 0; i < 64; i++) {
+        stars[i][2] -= speed;
+        if (stars[i][2] <= 0) {
+            stars[i][0] = (rand() % WIDTH) - WIDTH/2;
+            stars[i][1] = (rand() % HEIGHT) - HEIGHT/2;
+            stars[i][2] = 10;
+        }
+
+        // Project 3D to 2D
+        float px = stars[i][0] / stars[i][2] * 20 + WIDTH/2;
+        float py = stars[i][1] / stars[i][2] * 20 + HEIGHT/2;
+
+        if (px >= 0 && px < WIDTH && py >= 0 && py < HEIGHT) {
+            int intensity = (int)(br * (10 - stars[i][2]) / 10);
+            if (intensity > 255) intensity = 255;
+            fb.set((int)px, (int)py, intensity, intensity, intensity);
+        }
+    }
+}
+
+// ---------------------- VU Meter ---------------------------------
+class VuEffect : public Effect {
+public:
+    void reset() override { peakL = peakR = 0; }
+    void render(FrameBuffer &fb, float t, int br) override;
+
+private:
+    float peakL, peakR;  // peak hold
+};
+
+void VuEffect::render(FrameBuffer &fb, float t, int br) {
+
+    float vol = g_audio.volume;
+    float threshold = settings.noiseThreshold.load();
+    if (vol < threshold) vol = 0;
+
+    // Simulate stereo with slight variation
+    float left = vol * (0.9f + 0.2f * sin(vol * 10));
+    float right = vol * (0.9f + 0.2f * cos(vol * 10));
+
+    // Peak hold with decay
+    if (left > peakL) peakL = left;
+    else peakL *= 0.98f;
+    if (right > peakR) peakR = right;
+    else peakR *= 0.98f;
+
+    int hL = (int)(left * 60);
+    int hR = (int)(right * 60);
+    int peakLy = (int)(peakL * 60);
+    int peakRy = (int)(peakR * 60);
+
+    if (hL > HEIGHT) hL = HEIGHT;
+    if (hR > HEIGHT) hR = HEIGHT;
+    if (peakLy > HEIGHT) peakLy = HEIGHT;
+    if (peakRy > HEIGHT) peakRy = HEIGHT;
+
+    // Clear
+    fb.clear();
+
+    // Draw left channel (0-63) - RED
+    for (int y = HEIGHT - hL; y < HEIGHT; y++) {
+        float level = (float)(HEIGHT - y) / HEIGHT;
+        int intensity = (int)(br * (0.5f + level * 0.5f));
+        fb.hline(4, 60, y, packRGB(intensity, 0, 0));
+    }
+
+    // Draw right channel (64-127) - GREEN
+    for (int y = HEIGHT - hR; y < HEIGHT; y++) {
+        float level = (float)(HEIGHT - y) / HEIGHT;
+        int intensity = (int)(br * (0.5f + level * 0.5f));
+        fb.hline(68, 124, y, packRGB(0, intensity, 0));
+    }
+
+    // Peak indicators
+    uint32_t white = packRGB(br, br, br);
+    if (peakLy > 0) fb.hline(4, 60, HEIGHT - peakLy, white);
+    if (peakRy > 0) fb.hline(68, 124, HEIGHT - peakRy, white);
+}
+
+// ---------------------- Waveform ---------------------------------
+class WaveEffect : public Effect {
+public:
+    void reset() override { phase = hue = 0; }
+    void render(FrameBuffer &fb, float t, int br) override;
+
+private:
+    float phase;  // scroll position
+    float hue;
+};
+
+void WaveEffect::render(FrameBuffer &fb, float t, int br) {
+    float vol = g_audio.volume;
+    float beat = g_audio.beat;
+    float threshold = settings.noiseThreshold.load();
+    if (vol < threshold) vol = 0;
+
+    float dt = g_deltaTime.load();
+
+    // Clear
+    fb.clear();
+
+    // Live waveform - each column reacts to current audio
+    int cy = HEIGHT / 2;
+    float baseAmplitude = vol * 28.0f;
+
+    // Phase offset scrolls continuously (base speed + volume boost)
+    phase += dt * (3.0f + vol * 3.0f);
+
+    // Slow color cycling
+    hue += dt * 0.1f;  // Full cycle in ~10 seconds
+    if (hue > 1.0f) hue -= 1.0f;
+
+    for (int x = 0; x < WIDTH; x++) {
+        // Create wave pattern that reacts to current volume
+        float wave = sinf(x * 0.15f + phase) * 0.3f +
+                     sinf(x * 0.08f - phase * 0.7f) * 0.2f +
+                     0.5f;  // base offset
+
+        // Amplitude based on live volume, modulated by wave pattern
+        int amplitude = (int)(baseAmplitude * wave + beat * 8.0f);
+        if (amplitude < 1 && vol > 0.05f) amplitude = 1;  // minimum visibility when sound
+
+        // Color cycling, shifted by x position for a slight gradient across width
+        float h = hue + (float)x / WIDTH * 0.3f;
+
+        for (int dy = -amplitude; dy <= amplitude; dy++) {
+            int y = cy + dy;
+            if (y >= 0 && y < HEIGHT) {
+                float dist = (float)abs(dy) / (amplitude + 1);
+                float intensity = (1 - dist);
+                fb.set(x, y, hsvColor(h, br * intensity));
+            }
+        }
+    }
+}
+
+// ---------------------- Color Pulse ------------------------------
+class ColorPulseEffect : public Effect {
+public:
+    void reset() override { hue = 0; }
+    void render(FrameBuffer &fb, float t, int br) override;
+
+private:
+    float hue;
+};
+
+void ColorPulseEffect::render(FrameBuffer &fb, float t, int br) {
+
+    float vol = g_audio.volume;
+    float threshold = settings.noiseThreshold.load();
+    if (vol < threshold) vol = 0;
+
+    // Slowly shift hue over time
+    hue += 0.002f;
+    if (hue > 1.0f) hue -= 1.0f;
+
+    // Brightness based on volume
+    float intensity = 0.1f + vol * 0.9f;
+    if (intensity > 1.0f) intensity = 1.0f;
+
+    // Fill entire screen
+    uint32_t color = hsvColorExact(hue, br * intensity);
+    parallelRows(HEIGHT, RENDER_BAND, [&](int y0, int y1) { fb.fillRect(0, y0, WIDTH, y1, color); });
+}
+
+// ---------------------- Color Wipe --------------------------------
+class ColorWipeEffect : public Effect {
+public:
+    void reset() override {
+        hue = prevHue = 0;
+        direction = 0;
+        wipeProgress = 0;
+    }
+    void render(FrameBuffer &fb, float t, int br) override;
+
+private:
+    float hue;
+    float prevHue;
+    int direction;  // 0=left-right, 1=right-left, 2=top-bottom, 3=bottom-top
+    float wipeProgress;
+};
+
+void ColorWipeEffect::render(FrameBuffer &fb, float t, int br) {
+
+    float vol = g_audio.volume;
+    float threshold = settings.noiseThreshold.load();
+    if (vol < threshold) vol = 0;
+
+    // Wipe speed based on volume
+    float speed = 0.5f + vol * 2.0f;
+    wipeProgress += speed;
+
+    // Calculate wipe position
+    int maxPos;
+    if (direction == 0 || direction == 1) {
+        maxPos = WIDTH;
+    } else {
+        maxPos = HEIGHT;
+    }
+
+    int wipePos = (int)wipeProgress;
+
+    // When wipe completes, change direction and color
+    if (wipePos >= maxPos) {
+        wipeProgress = 0;
+        prevHue = hue;
+        hue += 0.15f;  // Jump to next color
+        if (hue > 1.0f) hue -= 1.0f;
+        direction = (direction + 1) % 4;  // Cycle through directions
+    }
+
+
+    uint32_t newColor = hsvColorExact(hue, br);
+    uint32_t oldColor = hsvColorExact(prevHue, br);
+
+    // Old color everywhere, then the wiped-in region on top
+    fb.fill(oldColor);
+    switch (direction) {
+        case 0:  // Left to right
+            fb.fillRect(0, 0, wipePos, HEIGHT, newColor);
+            break;
+        case 1:  // Right to left
+            fb.fillRect(WIDTH - wipePos, 0, WIDTH, HEIGHT, newColor);
+            break;
+        case 2:  // Top to bottom
+            fb.fillRect(0, 0, WIDTH, wipePos, newColor);
+            break;
+        case 3:  // Bottom to top
+            fb.fillRect(0, HEIGHT - wipePos, WIDTH, HEIGHT, newColor);
+            break;
+    }
+}
+
+// ---------------------- Spectrum 3D Waterfall ------------------------
+class Spectrum3dEffect : public Effect {
+public:
+    void reset() override {
+        memset(history, 0, sizeof(history));
+        frameCount = 0;
+    }
+    void render(FrameBuffer &fb, float t, int br) override;
+
+private:
+    static const int HISTORY_DEPTH = 32;  // Number of history lines
+    float history[HISTORY_DEPTH][8];      // Store spectrum history
+    int frameCount;
+};
+
+void Spectrum3dEffect::render(FrameBuffer &fb, float t, int br) {
+
+    // Current spectrum
+    const float* currentSpec = g_audio.spectrum;
+
+    float threshold = settings.noiseThreshold.load();
+
+    // Shift history back every few frames for slower movement
+    frameCount++;
+    if (frameCount >= 4) {
+        frameCount = 0;
+        for (int d = HISTORY_DEPTH - 1; d > 0; d--) {
+            for (int b = 0; b < 8; b++) {
+                history[d][b] = history[d-1][b];
+            }
+        }
+        // Add new spectrum line at front
+        for (int b = 0; b < 8; b++) {
+            float val = currentSpec[b];
+            if (val < threshold) val = 0;
+            history[0][b] = val;
+        }
+    }
+
+    // Clear screen
+    fb.clear();
+
+    const int W = fb.width(), H = fb.height();
+    const float k = renderScaleOf(fb);
+
+    // Draw 3D perspective lines - back to front so front overwrites
+    for (int d = HISTORY_DEPTH - 1; d >= 0; d--) {
+        float depthRatio = (float)d / HISTORY_DEPTH;
+
+        // Perspective: lines move up and shrink horizontally as they go back
+        int baseY = H - (int)(8 * k) - (int)(depthRatio * 50 * k);  // Move up with depth
+        float xScale = 1.0f - depthRatio * 0.5f;  // Shrink width with depth
+        int xCenter = W / 2 + (int)(depthRatio * 20 * k);  // Shift right slightly
+        float fade = 1.0f - depthRatio * 0.8f;  // Fade with depth
+
+        if (baseY < 2 * k) continue;
+
+        // Calculate line width at this depth
+        int lineWidth = (int)(W * 0.8f * xScale);
+        int startX = xCenter - lineWidth / 2;
+
+        // Brightness and depth fade as a 0-256 channel multiplier
+        uint32_t depthScale = (uint32_t)(fade * br * 256 / 255);
+
+        // Draw horizontal line with height based on spectrum values
+        for (int x = 0; x < lineWidth; x++) {
+            int px = startX + x;
+            if (px < 0 || px >= W) continue;
+
+            // Map x position to spectrum band (interpolate between bands)
+            float bandPos = (float)x / lineWidth * 7.0f;
+            int band1 = (int)bandPos;
+            int band2 = band1 + 1;
+            if (band2 > 7) band2 = 7;
+            float frac = bandPos - band1;
+
+            // Interpolate between adjacent bands
+            float val = history[d][band1] * (1.0f - frac) + history[d][band2] * frac;
+            int h = (int)(val * 0.4f * k);
+            if (h > 25 * k) h = (int)(25 * k);
+
+            // Color based on position (rainbow across width), dimmed by depth
+            uint32_t color = scaleColor(paletteRainbow[x * 256 / lineWidth], depthScale);
+
+            // Draw the point at height offset from baseline
+            int py = baseY - h;
+            if (py >= 0 && py < H) {
+                fb.set(px, py, color);
+            }
+        }
+    }
+}
+
+// ====================================================================
+// EFFECT DISPATCHER
+// ====================================================================
+template <class T>
+static Effect* createEffect() { return new T(); }
+
+#define EFFECT(name, type, scalable, policy) { name, scalable, policy, sizeof(type), createEffect<type> }
+
+// Order defines the effect ids (web UI, /set?effect=N)
+static const EffectInfo EFFECTS[] = {
+    EFFECT("Volume Bars", VolumeEffect,     true,  STATE_KEEP),
+    EFFECT("Beat Pulse",  BeatEffect,       false, STATE_KEEP),
+    EFFECT("Spectrum",    SpectrumEffect,   false, STATE_KEEP),
+    EFFECT("Plasma",      PlasmaEffect,     true,  STATE_RELEASE),
+    EFFECT("Fire",        FireEffect,       false, STATE_RELEASE),  // 32 KB heat map
+    EFFECT("Rain",        RainEffect,       false, STATE_KEEP),
+    EFFECT("Matrix",      MatrixEffect,     false, STATE_KEEP),
+    EFFECT("Starfield",   StarsEffect,      false, STATE_KEEP),
+    EFFECT("VU Meter",    VuEffect,         false, STATE_KEEP),
+    EFFECT("Waveform",    WaveEffect,       false, STATE_KEEP),
+    EFFECT("Color Pulse", ColorPulseEffect, false, STATE_KEEP),
+    EFFECT("Color Wipe",  ColorWipeEffect,  false, STATE_RESET),
+    EFFECT("Spectrum 3D", Spectrum3dEffect, true,  STATE_RESET),    // no stale history
+};
+
+#undef EFFECT
+
+static const int NUM_EFFECTS = sizeof(EFFECTS) / sizeof(EFFECTS[0]);
+
+// Live instances, indexed by id; nullptr until first activated
+static std::unique_ptr<Effect> instances[NUM_EFFECTS];
+static bool active[NUM_EFFECTS];        // shown in the previous or current frame
+static bool usedThisFrame[NUM_EFFECTS];
+static std::atomic<int> loadedCount{0};
+static std::atomic<size_t> loadedBytes{0};
+
+int effectCount() {
+    return NUM_EFFECTS;
+}
+
+const EffectInfo& effectInfo(int id) {
+    return EFFECTS[id];
+}
+
+const char* effectName(int id) {
+    return (id >= 0 && id < NUM_EFFECTS) ? EFFECTS[id].name : "?";
+}
+
+bool effectScalable(int id) {
+    return id >= 0 && id < NUM_EFFECTS && EFFECTS[id].scalable;
+}
+
+int loadedEffectCount() {
+    return loadedCount.load(std::memory_order_relaxed);
+}
+
+size_t loadedEffectBytes() {
+    return loadedBytes.load(std::memory_order_relaxed);
+}
+
+int autoEffect(float t) {
+    int duration = settings.effectDuration.load();
+    if (duration < 1) duration = 1;
+    return ((int)(t / duration)) % NUM_EFFECTS;
+}
+
+static void activateEffect(int id) {
+    active[id] = true;
+
+    Effect* e = instances[id].get();
+    if (!e) {
+        e = EFFECTS[id].create();
+        instances[id].reset(e);
+        e->init();
+        e->reset();
+        loadedCount.fetch_add(1, std::memory_order_relaxed);
+        loadedBytes.fetch_add(EFFECTS[id].stateBytes, std::memory_order_relaxed);
+    } else if (EFFECTS[id].policy == STATE_RESET) {
+        e->reset();
+    }
+}
+
+void renderEffect(int id, FrameBuffer &fb, float t, int br) {
+    if (id < 0 || id >= NUM_EFFECTS) return;
+    TRACE_SCOPE(EFFECTS[id].name);
+    if (!active[id]) activateEffect(id);
+    usedThisFrame[id] = true;
+    instances[id]->render(fb, t, br);
+}
+
+void endEffectFrame() {
+    for (int id = 0; id < NUM_EFFECTS; id++) {
+        if (active[id] && !usedThisFrame[id]) {
+            active[id] = false;
+            if (EFFECTS[id].policy == STATE_RELEASE) {
+                instances[id] = nullptr;
+                loadedCount.fetch_sub(1, std::memory_order_relaxed);
+                loadedBytes.fetch_sub(EFFECTS[id].stateBytes, std::memory_order_relaxed);
+            }
+        }
+        usedThisFrame[id] = false;
+    }
+}
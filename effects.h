@@ -0,0 +1,73 @@
+// ====================================================================
+//  EFFECTS
+//  All visual effects, drawn into the renderer's FrameBuffer. They read the shared
+//  settings, frame timing and the per-frame audio snapshot g_audio.
+//
+//  Each effect is an Effect object listed in a registry table (effects.cpp).
+//  Its state is allocated when the effect is first shown; what happens to
+//  it when the effect stops being drawn depends on its StatePolicy.
+// ====================================================================
+#pragma once
+
+#include <cstddef>
+#include "framebuffer.h"
+
+static const int VOLUME_MODE_COUNT = 6;  // sub-modes of effect 0 (Volume Bars)
+
+class Effect {
+public:
+    virtual ~Effect() {}
+
+    // One-time setup after allocation (tables that do not change)
+    virtual void init() {}
+
+    // Put the animation back to its starting state
+    virtual void reset() {}
+
+    // Draw one frame for time t; br is the effect brightness (0-255)
+    virtual void render(FrameBuffer &fb, float t, int br) = 0;
+};
+
+// What happens to an effect's state when another effect is selected
+enum StatePolicy {
+    STATE_KEEP,     // stays allocated, continues where it left off
+    STATE_RESET,    // stays allocated, reset() on the next activation
+    STATE_RELEASE,  // freed; allocated again on the next activation
+};
+
+struct EffectInfo {
+    const char* name;       // as in the web UI
+    bool scalable;          // draws at any FrameBuffer size (see scaler.h)
+    StatePolicy policy;
+    size_t stateBytes;      // size of the Effect object
+    Effect* (*create)();
+};
+
+// Number of registered effects; ids are 0 .. effectCount()-1
+int effectCount();
+
+const EffectInfo& effectInfo(int id);
+
+// Display name of effect 'id' (as in the web UI)
+const char* effectName(int id);
+
+// True if effect 'id' can draw into a FrameBuffer smaller than WIDTH x
+// HEIGHT (half or quarter size), to be upscaled afterwards
+bool effectScalable(int id);
+
+// Effect id for auto-cycling mode at time t (seconds)
+int autoEffect(float t);
+
+// Draw effect 'id' for time t; br is the effect brightness (0-255).
+// An effect that was not drawn in the previous frame is activated first
+// (allocating its state if needed). Render thread only.
+void renderEffect(int id, FrameBuffer &fb, float t, int br);
+
+// Call once per frame after rendering: effects not drawn in this frame are
+// deactivated and their StatePolicy applied. Several effects can be active
+// at once (e.g. both sides of a transition).
+void endEffectFrame();
+
+// Effects with allocated state and their total size (any thread)
+int loadedEffectCount();
+size_t loadedEffectBytes();
@@ -0,0 +1,61 @@
+// ====================================================================
+//  FRAME QUEUE
+//  Small bounded blocking FIFO used to hand canvases between the render
+//  thread and the presenter. push() waits while the queue is full and
+//  pop() waits while it is empty, so the faster side is paced by the
+//  slower one instead of running ahead.
+// ====================================================================
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+template <class T>
+class FrameQueue {
+public:
+    explicit FrameQueue(size_t capacity) : cap(capacity) {}
+
+    FrameQueue(const FrameQueue&) = delete;
+    FrameQueue& operator=(const FrameQueue&) = delete;
+
+    void push(const T& item) {
+        std::unique_lock<std::mutex> lock(mtx);
+        notFull.wait(lock, [this] { return items.size() < cap; });
+        items.push_back(item);
+        lock.unlock();
+        notEmpty.notify_one();
+    }
+
+    T pop() {
+        std::unique_lock<std::mutex> lock(mtx);
+        notEmpty.wait(lock, [this] { return !items.empty(); });
+        T item = items.front();
+        items.pop_front();
+        lock.unlock();
+        notFull.notify_one();
+        return item;
+    }
+
+    // Like pop(), but returns false instead of waiting when empty
+    bool tryPop(T& item) {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (items.empty()) return false;
+        item = items.front();
+        items.pop_front();
+        lock.unlock();
+        notFull.notify_one();
+        return true;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mtx);
+        return items.size();
+    }
+
+private:
+    size_t cap;
+    std::deque<T> items;
+    std::mutex mtx;
+    std::condition_variable notEmpty, notFull;
+};
@@ -0,0 +1,84 @@
+// ====================================================================
+//  FRAMEBUFFER
+//  Renderer-owned image the effects draw into: one contiguous, 64-byte
+//  aligned block of packed 0x00RRGGBB pixels, row-major, no padding.
+//  Writes are plain stores (no virtual call, no clipping); the finished
+//  frame goes to the output canvas in one PixelCanvas::Blit pass.
+// ====================================================================
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// Pack 8-bit channels; like SetPixel, values are truncated to 8 bits
+static inline uint32_t packRGB(int r, int g, int b) {
+    return ((uint32_t)(uint8_t)r << 16) | ((uint32_t)(uint8_t)g << 8) | (uint32_t)(uint8_t)b;
+}
+
+static inline uint8_t pixelR(uint32_t c) { return (uint8_t)(c >> 16); }
+static inline uint8_t pixelG(uint32_t c) { return (uint8_t)(c >> 8); }
+static inline uint8_t pixelB(uint32_t c) { return (uint8_t)c; }
+
+// (a * (256 - w) + b * w) / 256 per channel, w = 0..256. Red and blue are
+// blended together in one multiply, green in another.
+static inline uint32_t mixPixel(uint32_t a, uint32_t b, uint32_t w) {
+    uint32_t iw = 256 - w;
+    uint32_t rb = (((a & 0xFF00FF) * iw + (b & 0xFF00FF) * w) >> 8) & 0xFF00FF;
+    uint32_t g  = (((a & 0x00FF00) * iw + (b & 0x00FF00) * w) >> 8) & 0x00FF00;
+    return rb | g;
+}
+
+class FrameBuffer {
+public:
+    static const size_t ALIGN = 64;  // cache line
+
+    FrameBuffer(int w, int h) : w(w), h(h) {
+        size_t bytes = ((size_t)w * h * sizeof(uint32_t) + ALIGN - 1) & ~(ALIGN - 1);
+        px = (uint32_t*)aligned_alloc(ALIGN, bytes);
+        if (!px) throw std::bad_alloc();
+        clear();
+    }
+    ~FrameBuffer() { free(px); }
+
+    FrameBuffer(const FrameBuffer&) = delete;
+    FrameBuffer& operator=(const FrameBuffer&) = delete;
+
+    int width() const { return w; }
+    int height() const { return h; }
+    size_t pixelCount() const { return (size_t)w * h; }
+
+    uint32_t* data() { return px; }
+    const uint32_t* data() const { return px; }
+    uint32_t* row(int y) { return px + (size_t)y * w; }
+    const uint32_t* row(int y) const { return px + (size_t)y * w; }
+
+    void clear() { memset(px, 0, pixelCount() * sizeof(uint32_t)); }
+    void fill(uint32_t c) { std::fill(px, px + pixelCount(), c); }
+
+    // Unchecked: caller guarantees 0 <= x < width, 0 <= y < height
+    void set(int x, int y, uint32_t c) { px[(size_t)y * w + x] = c; }
+    void set(int x, int y, int r, int g, int b) { set(x, y, packRGB(r, g, b)); }
+    uint32_t get(int x, int y) const { return px[(size_t)y * w + x]; }
+
+    // Fill columns [x0, x1) of row y, clipped to the frame
+    void hline(int x0, int x1, int y, uint32_t c) {
+        if ((unsigned)y >= (unsigned)h) return;
+        if (x0 < 0) x0 = 0;
+        if (x1 > w) x1 = w;
+        if (x0 < x1) std::fill(row(y) + x0, row(y) + x1, c);
+    }
+
+    // Fill [x0, x1) x [y0, y1), clipped to the frame
+    void fillRect(int x0, int y0, int x1, int y1, uint32_t c) {
+        if (y0 < 0) y0 = 0;
+        if (y1 > h) y1 = h;
+        for (int y = y0; y < y1; y++) hline(x0, x1, y, c);
+    }
+
+private:
+    int w, h;
+    uint32_t* px;
+};
@@ -0,0 +1,60 @@
+// ====================================================================
+//  FRAME GOVERNOR (see governor.h)
+// ====================================================================
+
+#include "governor.h"
+#include "audio_led.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <ctime>
+
+static int64_t monotonicNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static void sleepUntilNs(int64_t ns) {
+    timespec ts;
+    ts.tv_sec = ns / 1000000000LL;
+    ts.tv_nsec = ns % 1000000000LL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {}
+}
+
+void FrameGovernor::waitForFrame() {
+    int fps = settings.targetFps.load();
+    int budget = std::max(1, std::min(100, settings.cpuBudget.load()));
+
+    // Frame period: target rate, stretched to keep work within the budget
+    int64_t periodNs = fps > 0 ? 1000000000LL / fps : 0;
+    if (budget < 100) periodNs = std::max(periodNs, (int64_t)(avgWorkUs * 1000.0f * 100 / budget));
+    pipeline.frameBudgetUs.store(periodNs > 0 ? (float)(periodNs / 1000) * budget / 100 : 0);
+
+    int64_t now = monotonicNs();
+    int64_t next = deadlineNs + periodNs;
+    if (periodNs == 0 || deadlineNs == 0) {
+        pipeline.paced.store(false, std::memory_order_relaxed);
+        next = now;  // unlimited (vsync-paced) or first frame
+    } else if (next < now) {
+        pipeline.paced.store(false, std::memory_order_relaxed);
+        pipeline.missed.fetch_add(1, std::memory_order_relaxed);
+        next = now;  // late: resync instead of rendering a burst of frames
+    } else {
+        pipeline.paced.store(true, std::memory_order_relaxed);
+        sleepUntilNs(next);
+        now = monotonicNs();
+    }
+    deadlineNs = next;
+
+    if (lastStartNs != 0) {
+        float interval = (now - lastStartNs) / 1000.0f;
+        avgIntervalUs += (interval - avgIntervalUs) / 16.0f;
+        if (avgIntervalUs > 0) pipeline.achievedFps.store(1e6f / avgIntervalUs);
+    }
+    lastStartNs = now;
+}
+
+void FrameGovernor::frameDone(float workUs) {
+    avgWorkUs += (workUs - avgWorkUs) / 16.0f;
+}
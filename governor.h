@@ -0,0 +1,34 @@
+// ====================================================================
+//  FRAME GOVERNOR
+//  Paces the render thread to settings.targetFps instead of letting it
+//  run as fast as vsync allows. Each frame has an absolute deadline on
+//  CLOCK_MONOTONIC and the thread sleeps until it with clock_nanosleep,
+//  so wake-up jitter does not accumulate into drift.
+//
+//  With a CPU budget below 100% the period is stretched whenever the
+//  measured work per frame would exceed that share of one core, e.g.
+//  budget 50% and 12 ms per frame -> at most one frame every 24 ms.
+//
+//  A frame that starts after its deadline counts as missed; the next
+//  deadline is then taken from "now" rather than catching up in a burst.
+//  pipeline.paced tells the presenter whether the frame in progress was
+//  held back by the governor, so pacing is not mistaken for starvation.
+// ====================================================================
+#pragma once
+
+#include <cstdint>
+
+class FrameGovernor {
+public:
+    // Blocks until the next frame is due. Call before rendering it.
+    void waitForFrame();
+
+    // Wall time the frame's work took (render + blit), in microseconds
+    void frameDone(float workUs);
+
+private:
+    int64_t deadlineNs = 0;      // when the last frame was due (0 = none yet)
+    int64_t lastStartNs = 0;
+    float avgWorkUs = 0;         // smoothed over ~16 frames
+    float avgIntervalUs = 0;
+};
@@ -0,0 +1,623 @@
+// ====================================================================
+//  HTTP SERVER (see http_server.h)
+// ====================================================================
+
+#include "http_server.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <zlib.h>
+
+static const int MAX_CONNECTIONS = 64;
+static const size_t MAX_HEADER_BYTES = 8192;
+static const size_t MAX_BODY_BYTES = 64 * 1024;
+static const int IDLE_TIMEOUT_SEC = 30;
+static const int MAX_EVENTS = 64;
+static const int MAX_IOV = 16;
+
+// Sent once when a connection subscribes to the event stream
+static const char EVENT_STREAM_HEAD[] =
+    "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n\r\nretry: 2000\n\n";
+
+static int64_t monotonicMs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static const char* statusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 503: return "Service Unavailable";
+        default:  return "Error";
+    }
+}
+
+static void appendHead(std::string& out, int status, const char* contentType, size_t length, bool keepAlive) {
+    out += "HTTP/1.1 ";
+    out += std::to_string(status);
+    out += ' ';
+    out += statusText(status);
+    out += "\r\nContent-Type: ";
+    out += contentType;
+    out += "\r\nContent-Length: ";
+    out += std::to_string(length);
+    out += keepAlive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+}
+
+static std::string lowerCase(std::string s) {
+    for (char& ch : s)
+        if (ch >= 'A' && ch <= 'Z') ch += 'a' - 'A';
+    return s;
+}
+
+static std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t");
+    if (b == std::string::npos) return "";
+    size_t e = s.find_last_not_of(" \t");
+    return s.substr(b, e - b + 1);
+}
+
+const std::string* HttpRequest::header(const char* name) const {
+    for (const auto& h : headers)
+        if (h.first == name) return &h.second;
+    return nullptr;
+}
+
+// Parse the request line and headers in [0, len) (without the blank line)
+static bool parseRequestHead(const std::string& text, size_t len, HttpRequest& req) {
+    size_t lineEnd = text.find("\r\n");
+    if (lineEnd == std::string::npos || lineEnd > len) lineEnd = len;
+
+    // METHOD SP TARGET SP VERSION
+    std::string line = text.substr(0, lineEnd);
+    size_t sp1 = line.find(' ');
+    size_t sp2 = line.rfind(' ');
+    if (sp1 == std::string::npos || sp2 == sp1) return false;
+    req.method = line.substr(0, sp1);
+    std::string target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+    std::string version = line.substr(sp2 + 1);
+    if (version.compare(0, 5, "HTTP/") != 0 || target.empty()) return false;
+    req.http11 = version != "HTTP/1.0";
+
+    size_t q = target.find('?');
+    req.path = target.substr(0, q);
+    req.query = q == std::string::npos ? "" : target.substr(q + 1);
+
+    size_t pos = lineEnd + 2;
+    while (pos < len) {
+        size_t end = text.find("\r\n", pos);
+        if (end == std::string::npos || end > len) end = len;
+        size_t colon = text.find(':', pos);
+        if (colon == std::string::npos || colon > end) return false;
+        req.headers.emplace_back(lowerCase(text.substr(pos, colon - pos)),
+                                 trim(text.substr(colon + 1, end - colon - 1)));
+        pos = end + 2;
+    }
+    return true;
+}
+
+static bool acceptsGzip(const HttpRequest& req) {
+    const std::string* enc = req.header("accept-encoding");
+    return enc && lowerCase(*enc).find("gzip") != std::string::npos;
+}
+
+// If-None-Match lists the client's cached ETags (or "*")
+static bool etagMatches(const HttpRequest& req, const std::string& etag) {
+    const std::string* inm = req.header("if-none-match");
+    return inm && (inm->find(etag) != std::string::npos || trim(*inm) == "*");
+}
+
+static bool wantsKeepAlive(const HttpRequest& req) {
+    const std::string* conn = req.header("connection");
+    std::string v = conn ? lowerCase(*conn) : "";
+    if (req.http11) return v.find("close") == std::string::npos;
+    return v.find("keep-alive") != std::string::npos;
+}
+
+// ---------------------- Message writer ---------------------------
+void MessageWriter::put(const char* s, size_t n) {
+    if (len + n > CAPACITY) {
+        over = true;
+        n = CAPACITY - len;
+    }
+    memcpy(buf + len, s, n);
+    len += n;
+}
+
+void MessageWriter::raw(const char* s) { put(s, strlen(s)); }
+
+void MessageWriter::integer(long long v) {
+    char tmp[24];
+    int n = 0;
+    unsigned long long u = v < 0 ? 0ull - (unsigned long long)v : (unsigned long long)v;
+    do {
+        tmp[sizeof(tmp) - 1 - n++] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u);
+    if (v < 0) tmp[sizeof(tmp) - 1 - n++] = '-';
+    put(tmp + sizeof(tmp) - n, n);
+}
+
+void MessageWriter::fixed(float v, int decimals) {
+    static const long long POW10[7] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+    decimals = std::max(0, std::min(6, decimals));
+    if (!std::isfinite(v)) v = 0;
+    long long scaled = llroundf(fabsf(v) * POW10[decimals]);
+    if (v < 0 && scaled) put("-", 1);
+    integer(scaled / POW10[decimals]);
+    if (decimals == 0) return;
+
+    char frac[8];
+    long long f = scaled % POW10[decimals];
+    for (int i = decimals - 1; i >= 0; i--, f /= 10) frac[i] = (char)('0' + f % 10);
+    put(".", 1);
+    put(frac, decimals);
+}
+
+// ---------------------- Static assets ----------------------------
+// gzip (RFC 1952) at maximum compression; empty on failure
+static std::string gzipCompress(const std::string& data) {
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+    // windowBits 15 + 16 selects the gzip wrapper instead of raw zlib
+    if (deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK) return "";
+
+    std::string out(deflateBound(&zs, data.size()), '\0');
+    zs.next_in = (Bytef*)data.data();
+    zs.avail_in = data.size();
+    zs.next_out = (Bytef*)&out[0];
+    zs.avail_out = out.size();
+    int rc = deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+    return rc == Z_STREAM_END ? out : "";
+}
+
+StaticAsset makeStaticAsset(const char* contentType, const std::string& body, const char* cacheControl) {
+    StaticAsset a;
+    a.body = body;
+    a.gzipBody = gzipCompress(body);
+    if (a.gzipBody.size() >= body.size()) a.gzipBody.clear();
+
+    // FNV-1a of the content: stable across restarts of the same build
+    uint64_t h = 1469598103934665603ull;
+    for (unsigned char ch : body) h = (h ^ ch) * 1099511628211ull;
+    char tag[24];
+    snprintf(tag, sizeof(tag), "\"%016llx\"", (unsigned long long)h);
+    a.etag = tag;
+
+    std::string common = std::string("\r\nETag: ") + a.etag + "\r\nCache-Control: " + cacheControl +
+                         "\r\nVary: Accept-Encoding";
+    for (int gz = 0; gz < 2; gz++) {
+        for (int ka = 0; ka < 2; ka++) {
+            bool compressed = gz && !a.gzipBody.empty();
+            std::string& s = a.head[gz][ka];
+            s = "HTTP/1.1 200 OK\r\nContent-Type: ";
+            s += contentType;
+            s += "\r\nContent-Length: ";
+            s += std::to_string(compressed ? a.gzipBody.size() : body.size());
+            if (compressed) s += "\r\nContent-Encoding: gzip";
+            s += common;
+            s += ka ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+        }
+    }
+    for (int ka = 0; ka < 2; ka++) {
+        a.notModified[ka] = "HTTP/1.1 304 Not Modified" + common;
+        a.notModified[ka] += ka ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+    }
+    return a;
+}
+
+// ---------------------- Server -----------------------------------
+// Unordered remove: the last entry takes fd's place
+static void removeFd(std::vector<int>& list, int fd) {
+    auto it = std::find(list.begin(), list.end(), fd);
+    if (it == list.end()) return;
+    *it = list.back();
+    list.pop_back();
+}
+
+HttpServer::HttpServer(int port, HttpHandler handler) : port(port), handler(std::move(handler)) {
+    subscribers.reserve(MAX_CONNECTIONS);
+    streamConns.reserve(MAX_CONNECTIONS);
+}
+
+void HttpServer::setEventRate(int hz) {
+    eventIntervalMs = 1000 / std::max(1, std::min(60, hz));
+}
+
+HttpServer::~HttpServer() {
+    for (auto& kv : conns) close(kv.first);
+    if (epollFd >= 0) close(epollFd);
+    if (listenFd >= 0) close(listenFd);
+}
+
+bool HttpServer::start() {
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        std::cerr << "Failed to create web server socket\n";
+        return false;
+    }
+
+    int opt = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+
+    if (bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        std::cerr << "Failed to bind web server to port " << port << "\n";
+        return false;
+    }
+    listen(listenFd, 64);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        std::cerr << "Failed to create epoll instance\n";
+        return false;
+    }
+    epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+    return true;
+}
+
+void HttpServer::run() {
+    epoll_event events[MAX_EVENTS];
+    while (true) {
+        // Wake for the next event or stream tick
+        int64_t wakeMs = monotonicMs() + 1000;
+        if (!subscribers.empty()) wakeMs = std::min(wakeMs, nextEventMs);
+        for (int fd : streamConns) wakeMs = std::min(wakeMs, conns[fd].nextStreamMs);
+        int timeoutMs = (int)std::max<int64_t>(0, wakeMs - monotonicMs());
+
+        int n = epoll_wait(epollFd, events, MAX_EVENTS, timeoutMs);
+        if (n < 0 && errno != EINTR) {
+            std::cerr << "epoll_wait failed: " << strerror(errno) << "\n";
+            return;
+        }
+
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                acceptClients();
+                continue;
+            }
+            auto it = conns.find(fd);
+            if (it == conns.end()) continue;
+            Connection& c = it->second;
+
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(fd);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) flush(c);
+            if (conns.count(fd) && (events[i].events & (EPOLLIN | EPOLLRDHUP))) onReadable(c);
+        }
+
+        int64_t now = monotonicMs();
+        if (subscribers.empty()) {
+            nextEventMs = now;  // first subscriber gets an event right away
+        } else if (now >= nextEventMs) {
+            broadcastEvent();
+            nextEventMs = std::max(nextEventMs + eventIntervalMs, now);
+        }
+        tickStreams(now);
+
+        closeIdle(now);
+    }
+}
+
+void HttpServer::acceptClients() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) return;  // EAGAIN: no more pending
+
+        if ((int)conns.size() >= MAX_CONNECTIONS) {
+            close(fd);
+            continue;
+        }
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            continue;
+        }
+
+        Connection& c = conns[fd];
+        c.fd = fd;
+        c.lastActiveMs = monotonicMs();
+        connCount.store((int)conns.size(), std::memory_order_relaxed);
+    }
+}
+
+void HttpServer::onReadable(Connection& c) {
+    int fd = c.fd;
+    char buf[4096];
+    bool peerClosed = false;
+    while (true) {
+        ssize_t r = read(fd, buf, sizeof(buf));
+        if (r > 0) {
+            c.in.append(buf, r);
+            continue;
+        }
+        if (r == 0) peerClosed = true;
+        else if (errno == EINTR) continue;
+        else if (errno != EAGAIN && errno != EWOULDBLOCK) peerClosed = true;
+        break;
+    }
+    c.lastActiveMs = monotonicMs();
+
+    // Subscribers and streams only receive; anything they send is discarded
+    if (c.subscriber || c.stream) c.in.clear();
+    else handleRequests(c);
+    if (!conns.count(fd)) return;
+    if (peerClosed) {
+        // Half-closed: send what is queued, then close
+        c.closeAfterWrite = true;
+        if (!c.pending()) closeConnection(fd);
+    }
+}
+
+void HttpServer::handleRequests(Connection& c) {
+    size_t consumed = 0;
+    while (!c.closeAfterWrite) {
+        size_t headEnd = c.in.find("\r\n\r\n", consumed);
+        if (headEnd == std::string::npos) {
+            if (c.in.size() - consumed > MAX_HEADER_BYTES) sendError(c, 431);
+            break;
+        }
+
+        HttpRequest req;
+        std::string head = c.in.substr(consumed, headEnd - consumed);
+        if (!parseRequestHead(head, head.size(), req)) {
+            sendError(c, 400);
+            break;
+        }
+
+        size_t bodyLen = 0;
+        if (const std::string* cl = req.header("content-length")) bodyLen = strtoul(cl->c_str(), nullptr, 10);
+        if (bodyLen > MAX_BODY_BYTES) {
+            sendError(c, 413);
+            break;
+        }
+        size_t total = headEnd + 4 + bodyLen - consumed;
+        if (c.in.size() - consumed < total) break;  // body not complete yet
+        consumed += total;
+
+        bool keepAlive = wantsKeepAlive(req);
+        HttpResponse resp = handler(req);
+        requests.fetch_add(1, std::memory_order_relaxed);
+        if (resp.eventStream) {
+            c.chunks.push_back({EVENT_STREAM_HEAD, 0, sizeof(EVENT_STREAM_HEAD) - 1});
+            c.subscriber = true;
+            subscribers.push_back(c.fd);
+            subCount.store((int)subscribers.size(), std::memory_order_relaxed);
+            consumed = c.in.size();
+            break;
+        }
+        if (resp.stream) {
+            size_t off = c.out.size();
+            c.out += "HTTP/1.1 200 OK\r\nContent-Type: ";
+            c.out += resp.stream->contentType();
+            c.out += "\r\nCache-Control: no-cache\r\nConnection: close\r\n\r\n";
+            c.chunks.push_back({nullptr, off, c.out.size() - off});
+            c.stream = std::move(resp.stream);
+            c.nextStreamMs = monotonicMs();
+            streamConns.push_back(c.fd);
+            consumed = c.in.size();
+            break;
+        }
+        queueResponse(c, &req, resp, keepAlive);
+        if (!keepAlive) c.closeAfterWrite = true;
+    }
+    // Anything after a closing request is never answered
+    if (c.closeAfterWrite) c.in.clear();
+    else c.in.erase(0, consumed);
+    flush(c);
+}
+
+void HttpServer::queueResponse(Connection& c, const HttpRequest* req, const HttpResponse& r, bool keepAlive) {
+    if (const StaticAsset* a = r.asset) {
+        // Prebuilt header + body, referenced in place
+        if (req && etagMatches(*req, a->etag)) {
+            c.chunks.push_back({a->notModified[keepAlive].data(), 0, a->notModified[keepAlive].size()});
+            return;
+        }
+        bool gz = req && !a->gzipBody.empty() && acceptsGzip(*req);
+        const std::string& head = a->head[gz][keepAlive];
+        const std::string& body = gz ? a->gzipBody : a->body;
+        c.chunks.push_back({head.data(), 0, head.size()});
+        if (!body.empty()) c.chunks.push_back({body.data(), 0, body.size()});
+        return;
+    }
+
+    size_t off = c.out.size();
+    appendHead(c.out, r.status, r.contentType.c_str(), r.body.size(), keepAlive);
+    c.out += r.body;
+    c.chunks.push_back({nullptr, off, c.out.size() - off});
+}
+
+void HttpServer::sendError(Connection& c, int status) {
+    HttpResponse r;
+    r.status = status;
+    r.body = statusText(status);
+    queueResponse(c, nullptr, r, false);
+    c.closeAfterWrite = true;
+}
+
+void HttpServer::flush(Connection& c) {
+    int fd = c.fd;
+    while (c.pending()) {
+        // Gather the queued chunks; 'out' may have grown since they were
+        // queued, so pointers into it are formed only here
+        iovec iov[MAX_IOV];
+        int n = 0;
+        for (size_t i = c.chunkIdx; i < c.chunks.size() && n < MAX_IOV; i++, n++) {
+            const OutChunk& ch = c.chunks[i];
+            size_t skip = i == c.chunkIdx ? c.chunkPos : 0;
+            const char* base = ch.ext ? ch.ext : c.out.data() + ch.off;
+            iov[n].iov_base = (void*)(base + skip);
+            iov[n].iov_len = ch.len - skip;
+        }
+
+        // sendmsg is writev with flags: MSG_NOSIGNAL keeps a closed peer
+        // from raising SIGPIPE
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = n;
+        ssize_t w = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR) continue;
+        if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (w <= 0) {
+            closeConnection(fd);
+            return;
+        }
+
+        c.lastActiveMs = monotonicMs();
+        size_t sent = (size_t)w;
+        while (sent > 0) {
+            size_t left = c.chunks[c.chunkIdx].len - c.chunkPos;
+            if (sent < left) {
+                c.chunkPos += sent;
+                break;
+            }
+            sent -= left;
+            c.chunkIdx++;
+            c.chunkPos = 0;
+        }
+    }
+
+    bool pending = c.pending();
+    if (!pending) {
+        // Buffers keep their capacity for the next response
+        c.out.clear();
+        c.chunks.clear();
+        c.chunkIdx = 0;
+        c.chunkPos = 0;
+        if (c.closeAfterWrite) {
+            closeConnection(fd);
+            return;
+        }
+    }
+
+    // Watch for writability only while a response is unfinished
+    if (pending != c.wantWrite) {
+        epoll_event ev;
+        ev.events = EPOLLIN | EPOLLRDHUP | (pending ? (uint32_t)EPOLLOUT : 0u);
+        ev.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev);
+        c.wantWrite = pending;
+    }
+}
+
+void HttpServer::broadcastEvent() {
+    TRACE_SCOPE("sse_broadcast");
+    // Subscribers that have not finished the previous event still point
+    // into eventMsg: give them a private copy, and skip them this tick
+    for (int fd : subscribers) {
+        Connection& c = conns[fd];
+        if (c.pending()) detachEvent(c);
+    }
+
+    eventMsg.clear();
+    eventMsg.raw("data: ");
+    if (eventSource) eventSource(eventMsg);
+    eventMsg.raw("\n\n");
+
+    // Backwards: flush() may close a connection, which swap-removes it
+    for (size_t i = subscribers.size(); i-- > 0;) {
+        Connection& c = conns[subscribers[i]];
+        if (c.pending()) {
+            eventsSkipped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        c.chunks.push_back({eventMsg.data(), 0, eventMsg.size()});
+        eventsOut.fetch_add(1, std::memory_order_relaxed);
+        flush(c);
+    }
+}
+
+void HttpServer::tickStreams(int64_t nowMs) {
+    // Backwards: flush() may close a connection, which swap-removes it
+    for (size_t i = streamConns.size(); i-- > 0;) {
+        Connection& c = conns[streamConns[i]];
+        if (nowMs < c.nextStreamMs) continue;
+        c.nextStreamMs = std::max(c.nextStreamMs + c.stream->intervalMs(), nowMs);
+
+        // Still sending the last message: skip rather than queue up
+        if (c.pending()) continue;
+        size_t off = c.out.size();
+        if (!c.stream->next(c.out)) continue;
+        c.chunks.push_back({nullptr, off, c.out.size() - off});
+        flush(c);
+    }
+}
+
+void HttpServer::detachEvent(Connection& c) {
+    for (size_t i = c.chunkIdx; i < c.chunks.size(); i++) {
+        OutChunk& ch = c.chunks[i];
+        if (!ch.ext || !eventMsg.contains(ch.ext)) continue;
+        size_t skip = i == c.chunkIdx ? c.chunkPos : 0;
+        size_t off = c.out.size();
+        c.out.append(ch.ext + skip, ch.len - skip);
+        ch = {nullptr, off, ch.len - skip};
+        if (i == c.chunkIdx) c.chunkPos = 0;
+    }
+}
+
+void HttpServer::closeConnection(int fd) {
+    auto it = conns.find(fd);
+    if (it != conns.end() && it->second.subscriber) {
+        removeFd(subscribers, fd);
+        subCount.store((int)subscribers.size(), std::memory_order_relaxed);
+    }
+    if (it != conns.end() && it->second.stream) removeFd(streamConns, fd);
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    conns.erase(fd);
+    connCount.store((int)conns.size(), std::memory_order_relaxed);
+}
+
+void HttpServer::closeIdle(int64_t nowMs) {
+    std::vector<int> idle;
+    for (auto& kv : conns) {
+        const Connection& c = kv.second;
+        // Push connections may legitimately have nothing to send; they
+        // only count as idle when output is stuck
+        bool pushing = c.subscriber || c.stream;
+        if (nowMs - c.lastActiveMs > IDLE_TIMEOUT_SEC * 1000 && (!pushing || c.pending())) idle.push_back(kv.first);
+    }
+    for (int fd : idle) closeConnection(fd);
+}
@@ -0,0 +1,185 @@
+// ====================================================================
+//  HTTP SERVER
+//  Event-driven HTTP/1.1 server for the control interface. One thread
+//  runs an epoll loop over non-blocking sockets, so a slow client only
+//  holds its own connection:
+//    - keep-alive (HTTP/1.1 default, "Connection: keep-alive" on 1.0)
+//    - requests are framed by the header terminator and Content-Length;
+//      partial reads are buffered per connection, pipelined requests
+//      are answered in order
+//    - responses that do not fit the socket buffer are finished on
+//      EPOLLOUT
+//    - idle connections are closed after IDLE_TIMEOUT_SEC
+//    - static assets are assembled and gzipped once (makeStaticAsset);
+//      a request for one sends the prebuilt header and body straight
+//      from memory with one scatter-gather write, or 304 on ETag match
+//    - Server-Sent Events: a handler can turn its connection into an
+//      event stream subscriber; every tick one message is encoded into
+//      a fixed buffer and the same bytes are queued on all subscribers
+//    - per-connection streams (HttpStream): a handler can hand the
+//      connection a stream object that produces its own messages at its
+//      own rate; ticks are skipped while the client is still receiving
+// ====================================================================
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct HttpRequest {
+    std::string method;
+    std::string path;     // without the query string
+    std::string query;    // text after '?', may be empty
+    bool http11 = true;
+    std::vector<std::pair<std::string, std::string>> headers;  // names lower-case
+
+    // Value of header 'name' (lower-case), or nullptr
+    const std::string* header(const char* name) const;
+};
+
+// Fixed-capacity text buffer for event payloads; never allocates.
+// Output past the capacity is dropped and overflowed() turns true.
+class MessageWriter {
+public:
+    static const size_t CAPACITY = 2048;
+
+    void clear() { len = 0; over = false; }
+    void raw(const char* s);
+    void integer(long long v);
+    void fixed(float v, int decimals);  // decimals 0-6
+
+    const char* data() const { return buf; }
+    size_t size() const { return len; }
+    bool overflowed() const { return over; }
+    bool contains(const char* p) const { return p >= buf && p < buf + CAPACITY; }
+
+private:
+    void put(const char* s, size_t n);
+
+    char buf[CAPACITY];
+    size_t len = 0;
+    bool over = false;
+};
+
+// Response prebuilt at startup. Bodies and header blocks never change
+// after makeStaticAsset(), so connections send them without copying.
+struct StaticAsset {
+    std::string etag;              // quoted, e.g. "\"1f0c...\""
+    std::string body;
+    std::string gzipBody;          // empty when gzip does not shrink the body
+    std::string head[2][2];        // 200 header block, [gzip][keepAlive]
+    std::string notModified[2];    // 304 header block, [keepAlive]
+};
+
+// Build a StaticAsset for 'body'; cacheControl is sent verbatim
+StaticAsset makeStaticAsset(const char* contentType, const std::string& body, const char* cacheControl);
+
+// Push stream owned by one connection. The response has no Content-Length
+// and ends when either side closes.
+class HttpStream {
+public:
+    virtual ~HttpStream() {}
+    virtual const char* contentType() const = 0;
+    virtual int intervalMs() const = 0;
+    // Append the next message to 'out'; false when there is nothing new
+    virtual bool next(std::string& out) = 0;
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string contentType = "text/plain";
+    std::string body;
+    const StaticAsset* asset = nullptr;  // when set, sent instead of the fields above
+    bool eventStream = false;            // subscribe the connection to the event stream
+    std::unique_ptr<HttpStream> stream;  // hand the connection to a push stream
+};
+
+typedef std::function<HttpResponse(const HttpRequest&)> HttpHandler;
+
+// Writes the data of one event (without the "data: " framing)
+typedef std::function<void(MessageWriter&)> EventSource;
+
+class HttpServer {
+public:
+    HttpServer(int port, HttpHandler handler);
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    // Create the listening socket; false (with a message on stderr) on error
+    bool start();
+
+    // Event loop; does not return
+    void run();
+
+    // Event stream: 'source' is called once per tick while anyone is subscribed
+    void setEventSource(EventSource source) { eventSource = std::move(source); }
+    void setEventRate(int hz);
+
+    int openConnections() const { return connCount.load(std::memory_order_relaxed); }
+    uint64_t requestCount() const { return requests.load(std::memory_order_relaxed); }
+    int subscriberCount() const { return subCount.load(std::memory_order_relaxed); }
+    uint64_t eventsSent() const { return eventsOut.load(std::memory_order_relaxed); }
+    uint64_t eventsDropped() const { return eventsSkipped.load(std::memory_order_relaxed); }
+
+private:
+    // Queued output: bytes in Connection::out, or a static asset's memory
+    struct OutChunk {
+        const char* ext;          // nullptr: [off, off + len) of Connection::out
+        size_t off, len;
+    };
+
+    struct Connection {
+        int fd = -1;
+        std::string in;           // received, not yet handled
+        std::string out;          // serialized dynamic responses
+        std::vector<OutChunk> chunks;
+        size_t chunkIdx = 0;      // first unsent chunk
+        size_t chunkPos = 0;      // bytes of it already sent
+        bool closeAfterWrite = false;
+        bool wantWrite = false;   // EPOLLOUT registered
+        bool subscriber = false;  // receiving the event stream
+        int64_t lastActiveMs = 0;
+        std::unique_ptr<HttpStream> stream;
+        int64_t nextStreamMs = 0;
+
+        bool pending() const { return chunkIdx < chunks.size(); }
+    };
+
+    void acceptClients();
+    void onReadable(Connection& c);
+    void handleRequests(Connection& c);
+    void flush(Connection& c);
+    void closeConnection(int fd);
+    void closeIdle(int64_t nowMs);
+    void sendError(Connection& c, int status);
+    void queueResponse(Connection& c, const HttpRequest* req, const HttpResponse& r, bool keepAlive);
+    void broadcastEvent();
+    void tickStreams(int64_t nowMs);
+    void detachEvent(Connection& c);
+
+    int port;
+    HttpHandler handler;
+    int listenFd = -1;
+    int epollFd = -1;
+    std::unordered_map<int, Connection> conns;
+
+    std::vector<int> subscribers;
+    std::vector<int> streamConns;
+    EventSource eventSource;
+    MessageWriter eventMsg;       // the current event, shared by all subscribers
+    int eventIntervalMs = 33;
+    int64_t nextEventMs = 0;
+
+    std::atomic<int> connCount{0};
+    std::atomic<uint64_t> requests{0};
+    std::atomic<int> subCount{0};
+    std::atomic<uint64_t> eventsOut{0};
+    std::atomic<uint64_t> eventsSkipped{0};
+};
@@ -0,0 +1,90 @@
+#ifndef KISS_FFT_GUTS_H
+#define KISS_FFT_GUTS_H
+
+/* Internal helpers shared by the kissfft translation units.
+ * Not part of the public API - include kiss_fft.h instead. */
+
+#include "kiss_fft.h"
+#include <string.h>
+
+#define MAXFACTORS 32
+
+/* factors[] holds (radix, stride) pairs in the order the stages are run.
+ * twiddles[] is a trailing array of nfft entries, followed by scratch
+ * space for the generic (odd prime) butterfly. Both live in the same
+ * block so a cfg can be placed in caller-provided memory. */
+struct kiss_fft_state {
+    int nfft;
+    int inverse;
+    int factors[2*MAXFACTORS];
+    kiss_fft_cpx *scratch;
+    kiss_fft_cpx twiddles[1];
+};
+
+#ifdef FIXED_POINT
+#define FRACBITS 15
+#define SAMPPROD int32_t
+#define SAMP_MAX 32767
+
+#define smul(a,b) ( (SAMPPROD)(a)*(b) )
+#define sround( x )  (kiss_fft_scalar)( ( (x) + (1<<(FRACBITS-1)) ) >> FRACBITS )
+
+#define S_MUL(a,b) sround( smul(a,b) )
+
+#define C_MUL(m,a,b) \
+    do{ (m).r = sround( smul((a).r,(b).r) - smul((a).i,(b).i) ); \
+        (m).i = sround( smul((a).r,(b).i) + smul((a).i,(b).r) ); }while(0)
+
+#define DIVSCALAR(x,k) \
+    (x) = sround( smul( x, SAMP_MAX/k ) )
+
+/* Each butterfly stage divides by its radix so the output can't overflow */
+#define C_FIXDIV(c,div) \
+    do { DIVSCALAR( (c).r , div); \
+         DIVSCALAR( (c).i , div); }while (0)
+
+#define C_MULBYSCALAR( c, s ) \
+    do{ (c).r = sround( smul( (c).r , s ) ) ;\
+        (c).i = sround( smul( (c).i , s ) ) ; }while(0)
+
+#else  /* not FIXED_POINT*/
+
+#define S_MUL(a,b) ( (a)*(b) )
+
+#define C_MUL(m,a,b) \
+    do{ (m).r = (a).r*(b).r - (a).i*(b).i;\
+        (m).i = (a).r*(b).i + (a).i*(b).r; }while(0)
+
+/* Per-stage scaling hook; only meaningful for integer scalars. */
+#define C_FIXDIV(c,div) /* NOOP */
+
+#define C_MULBYSCALAR( c, s ) \
+    do{ (c).r *= (s);\
+        (c).i *= (s); }while(0)
+
+#endif
+
+#define C_ADD( res, a,b)\
+    do { (res).r=(a).r+(b).r;  (res).i=(a).i+(b).i; }while(0)
+#define C_SUB( res, a,b)\
+    do { (res).r=(a).r-(b).r;  (res).i=(a).i-(b).i; }while(0)
+#define C_ADDTO( res , a)\
+    do { (res).r += (a).r;  (res).i += (a).i; }while(0)
+#define C_SUBFROM( res , a)\
+    do { (res).r -= (a).r;  (res).i -= (a).i; }while(0)
+
+#ifdef FIXED_POINT
+#define KISS_FFT_COS(phase) floor(.5+SAMP_MAX * cos (phase))
+#define KISS_FFT_SIN(phase) floor(.5+SAMP_MAX * sin (phase))
+#define HALF_OF(x) ((x)>>1)
+#else
+#define KISS_FFT_COS(phase) (kiss_fft_scalar) cos(phase)
+#define KISS_FFT_SIN(phase) (kiss_fft_scalar) sin(phase)
+#define HALF_OF(x) ((x)*(kiss_fft_scalar).5)
+#endif
+
+#define kf_cexp(x,phase) \
+    do{ (x)->r = KISS_FFT_COS(phase);\
+        (x)->i = KISS_FFT_SIN(phase); }while(0)
+
+#endif
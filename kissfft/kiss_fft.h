@@ -5,8 +5,17 @@
 #include <stdio.h>
 #include <math.h>
 
-#ifndef kiss_fft_scalar
-#define kiss_fft_scalar float
+/* Build with -DFIXED_POINT for a Q15 transform on int16_t samples (for
+ * cores without a usable FPU, e.g. the ARMv6 Pi Zero). Fixed-point
+ * transforms scale by 1/nfft internally to stay inside 16 bits, so
+ * kiss_fft() returns DFT/nfft there instead of the plain DFT. */
+#ifdef FIXED_POINT
+#include <stdint.h>
+# define kiss_fft_scalar int16_t
+#else
+# ifndef kiss_fft_scalar
+#  define kiss_fft_scalar float
+# endif
 #endif
 
 #ifdef __cplusplus
@@ -20,13 +29,62 @@ typedef struct {
 
 typedef struct kiss_fft_state* kiss_fft_cfg;
 
+/*
+ *  kiss_fft_alloc
+ *
+ *  Initialize a FFT (or IFFT) configuration for nfft points. Any nfft is
+ *  accepted; sizes that factor into 2, 3, 4 and 5 are fastest, other prime
+ *  factors fall back to a generic O(p^2) butterfly.
+ *
+ *  Typical usage:      kiss_fft_cfg mycfg=kiss_fft_alloc(1024,0,NULL,NULL);
+ *
+ *  The return value from fft_alloc is a cfg buffer used internally
+ *  by the fft routine or NULL.
+ *
+ *  If lenmem is NULL, then kiss_fft_alloc will allocate a cfg buffer using malloc.
+ *  The returned value should be free()d when done to avoid memory leaks.
+ *
+ *  The state can be placed in a user supplied buffer 'mem':
+ *  If lenmem is not NULL and mem is not NULL and *lenmem is large enough,
+ *      then the function places the cfg in mem and the size used in *lenmem
+ *      and returns mem.
+ *
+ *  If lenmem is not NULL and ( mem is NULL or *lenmem is not large enough),
+ *      then the function returns NULL and places the minimum cfg
+ *      buffer size in *lenmem.
+ */
 kiss_fft_cfg kiss_fft_alloc(int nfft, int inverse_fft,
                             void * mem, size_t * lenmem);
 
+/*
+ * kiss_fft(cfg,in_out_buf)
+ *
+ * Perform an FFT on a complex input buffer.
+ * for a forward FFT,
+ * fin should be  f[0] , f[1] , ... ,f[nfft-1]
+ * fout will be   F[0] , F[1] , ... ,F[nfft-1]
+ * Note that each element is complex and can be accessed like
+ *  f[k].r and f[k].i
+ *
+ * fin and fout must not overlap. The transforms are unnormalized:
+ * inverse(forward(x)) == nfft * x.
+ * */
 void kiss_fft(kiss_fft_cfg cfg,
               const kiss_fft_cpx *fin,
               kiss_fft_cpx *fout);
 
+/*
+ * A more generic version of the above function. It reads its input from every Nth sample.
+ * */
+void kiss_fft_stride(kiss_fft_cfg cfg,
+                     const kiss_fft_cpx *fin,
+                     kiss_fft_cpx *fout,
+                     int fin_stride);
+
+/* If kiss_fft_alloc allocated a buffer, it is one contiguous
+   buffer and can be simply free()d when no longer needed*/
+#define kiss_fft_free free
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,187 @@
+// ====================================================================
+//  HTTP LOAD GENERATOR
+//  Hammers the web interface from several client threads and reports
+//  throughput and request latency. Build with: make loadgen
+//
+//  Options:
+//    --host=ADDR     server IPv4 address (default 127.0.0.1)
+//    --port=N        server port (default 8080)
+//    --conns=N       concurrent client connections (default 8)
+//    --requests=N    requests per connection (default 1000)
+//    --path=P        request target (default /status)
+//    --close         new connection per request instead of keep-alive
+//    --stalled=N     extra connections that send half a request and then
+//                    sit idle for the whole run (slow-client simulation)
+// ====================================================================
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+struct Options {
+    const char* host = "127.0.0.1";
+    int port = 8080;
+    int conns = 8;
+    int requests = 1000;
+    std::string path = "/status";
+    bool keepAlive = true;
+    int stalled = 0;
+};
+
+static int connectTo(const Options& o) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(o.port);
+    inet_pton(AF_INET, o.host, &addr.sin_addr);
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+static bool sendAll(int fd, const std::string& s) {
+    size_t off = 0;
+    while (off < s.size()) {
+        ssize_t w = send(fd, s.data() + off, s.size() - off, MSG_NOSIGNAL);
+        if (w <= 0) return false;
+        off += w;
+    }
+    return true;
+}
+
+// Read one response (headers + Content-Length body); false on error/EOF.
+// Bytes past the response stay in 'buf' for the next call.
+static bool readResponse(int fd, std::string& buf) {
+    char tmp[16384];
+    size_t headEnd;
+    while ((headEnd = buf.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t r = read(fd, tmp, sizeof(tmp));
+        if (r <= 0) return false;
+        buf.append(tmp, r);
+    }
+    if (buf.compare(0, 12, "HTTP/1.1 200") != 0) return false;
+
+    size_t bodyLen = 0;
+    size_t cl = buf.find("Content-Length:");
+    if (cl != std::string::npos && cl < headEnd) bodyLen = strtoul(buf.c_str() + cl + 15, nullptr, 10);
+
+    size_t total = headEnd + 4 + bodyLen;
+    while (buf.size() < total) {
+        ssize_t r = read(fd, tmp, sizeof(tmp));
+        if (r <= 0) return false;
+        buf.append(tmp, r);
+    }
+    buf.erase(0, total);
+    return true;
+}
+
+static void clientLoop(const Options& o, std::vector<double>& latUs, std::atomic<int>& errors) {
+    std::string req = "GET " + o.path + " HTTP/1.1\r\nHost: loadgen\r\n";
+    req += o.keepAlive ? "\r\n" : "Connection: close\r\n\r\n";
+
+    int fd = -1;
+    std::string buf;
+    for (int i = 0; i < o.requests; i++) {
+        auto t0 = std::chrono::steady_clock::now();
+        if (fd < 0) {
+            fd = connectTo(o);
+            buf.clear();
+            if (fd < 0) {
+                errors++;
+                continue;
+            }
+        }
+        bool ok = sendAll(fd, req) && readResponse(fd, buf);
+        auto t1 = std::chrono::steady_clock::now();
+
+        if (ok) latUs.push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+        else errors++;
+        if (!ok || !o.keepAlive) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    if (fd >= 0) close(fd);
+}
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t i = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+int main(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--host=", 7) == 0) {
+            o.host = argv[i] + 7;
+        } else if (strncmp(argv[i], "--port=", 7) == 0) {
+            o.port = atoi(argv[i] + 7);
+        } else if (strncmp(argv[i], "--conns=", 8) == 0) {
+            o.conns = std::max(1, atoi(argv[i] + 8));
+        } else if (strncmp(argv[i], "--requests=", 11) == 0) {
+            o.requests = std::max(1, atoi(argv[i] + 11));
+        } else if (strncmp(argv[i], "--path=", 7) == 0) {
+            o.path = argv[i] + 7;
+        } else if (strcmp(argv[i], "--close") == 0) {
+            o.keepAlive = false;
+        } else if (strncmp(argv[i], "--stalled=", 10) == 0) {
+            o.stalled = std::max(0, atoi(argv[i] + 10));
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            fprintf(stderr, "Usage: %s [--host=ADDR] [--port=N] [--conns=N] [--requests=N] [--path=P] [--close] [--stalled=N]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    // Slow clients: a request line without the terminating blank line
+    std::vector<int> stalled;
+    for (int i = 0; i < o.stalled; i++) {
+        int fd = connectTo(o);
+        if (fd < 0) break;
+        sendAll(fd, "GET " + o.path + " HTTP/1.1\r\n");
+        stalled.push_back(fd);
+    }
+
+    std::vector<std::vector<double>> lat(o.conns);
+    std::atomic<int> errors{0};
+    std::vector<std::thread> threads;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int c = 0; c < o.conns; c++)
+        threads.emplace_back(clientLoop, std::cref(o), std::ref(lat[c]), std::ref(errors));
+    for (auto& t : threads) t.join();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    for (int fd : stalled) close(fd);
+
+    std::vector<double> all;
+    for (auto& v : lat) all.insert(all.end(), v.begin(), v.end());
+    std::sort(all.begin(), all.end());
+
+    printf("%s %s, %d connections x %d requests, %zu stalled\n", o.path.c_str(),
+           o.keepAlive ? "keep-alive" : "close", o.conns, o.requests, stalled.size());
+    printf("  ok %zu  errors %d  in %.2f s  ->  %.0f req/s\n", all.size(), errors.load(), secs,
+           secs > 0 ? all.size() / secs : 0.0);
+    printf("  latency us: p50 %.0f  p90 %.0f  p99 %.0f  max %.0f\n", percentile(all, 0.50),
+           percentile(all, 0.90), percentile(all, 0.99), all.empty() ? 0.0 : all.back());
+    return errors.load() ? 1 : 0;
+}
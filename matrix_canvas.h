@@ -0,0 +1,41 @@
+// ====================================================================
+//  MATRIX CANVAS
+//  PixelCanvas backend that draws into an rpi-rgb-led-matrix FrameCanvas.
+// ====================================================================
+#pragma once
+
+#include "canvas.h"
+#include "led-matrix.h"
+
+class MatrixCanvas : public PixelCanvas {
+public:
+    explicit MatrixCanvas(rgb_matrix::FrameCanvas* fc) : fc(fc) {}
+
+    // SwapOnVSync hands back a different buffer every frame
+    void setTarget(rgb_matrix::FrameCanvas* next) { fc = next; }
+
+    int width() const override { return fc->width(); }
+    int height() const override { return fc->height(); }
+
+    void SetPixel(int x, int y, uint8_t r, uint8_t g, uint8_t b) override {
+        fc->SetPixel(x, y, r, g, b);
+    }
+
+    void Clear() override { fc->Clear(); }
+
+    // One pass over the finished frame straight into the FrameCanvas
+    void Blit(const FrameBuffer& fb) override {
+        int bw = std::min(fb.width(), fc->width());
+        int bh = std::min(fb.height(), fc->height());
+        for (int y = 0; y < bh; y++) {
+            const uint32_t* src = fb.row(y);
+            for (int x = 0; x < bw; x++) {
+                uint32_t c = src[x];
+                fc->SetPixel(x, y, pixelR(c), pixelG(c), pixelB(c));
+            }
+        }
+    }
+
+private:
+    rgb_matrix::FrameCanvas* fc;
+};
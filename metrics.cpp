@@ -0,0 +1,68 @@
+// ====================================================================
+//  METRICS (see metrics.h)
+// ====================================================================
+
+#include "metrics.h"
+
+#include <cstdio>
+
+Metrics metrics;
+
+// 10 us (one FFT on a fast core) to 50 ms (three frames at 60 fps)
+const float LatencyHistogram::BOUNDS_US[BUCKETS] = {
+    10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+};
+
+void LatencyHistogram::observe(float us) {
+    int b = 0;
+    while (b < BUCKETS && us > BOUNDS_US[b]) b++;
+    counts[b].fetch_add(1, std::memory_order_relaxed);
+    sumNs.fetch_add(us > 0 ? (uint64_t)(us * 1000.0f) : 0, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::write(std::string& out, const char* name, const char* labels) const {
+    if (!labels) labels = "";
+    const char* sep = *labels ? "," : "";
+    char line[256];
+
+    uint64_t cumulative = 0;
+    for (int b = 0; b <= BUCKETS; b++) {
+        cumulative += counts[b].load(std::memory_order_relaxed);
+        if (b < BUCKETS)
+            snprintf(line, sizeof(line), "%s_bucket{%s%sle=\"%g\"} %llu\n", name, labels, sep,
+                     BOUNDS_US[b] / 1e6, (unsigned long long)cumulative);
+        else
+            snprintf(line, sizeof(line), "%s_bucket{%s%sle=\"+Inf\"} %llu\n", name, labels, sep,
+                     (unsigned long long)cumulative);
+        out += line;
+    }
+
+    double sumSec = sumNs.load(std::memory_order_relaxed) / 1e9;
+    if (*labels) {
+        snprintf(line, sizeof(line), "%s_sum{%s} %.9g\n%s_count{%s} %llu\n", name, labels, sumSec, name, labels,
+                 (unsigned long long)cumulative);
+    } else {
+        snprintf(line, sizeof(line), "%s_sum %.9g\n%s_count %llu\n", name, sumSec, name,
+                 (unsigned long long)cumulative);
+    }
+    out += line;
+}
+
+void writeMetricHeader(std::string& out, const char* name, const char* type, const char* help) {
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void writeMetricValue(std::string& out, const char* name, const char* labels, double value) {
+    char line[256];
+    if (labels && *labels) snprintf(line, sizeof(line), "%s{%s} %.10g\n", name, labels, value);
+    else snprintf(line, sizeof(line), "%s %.10g\n", name, value);
+    out += line;
+}
@@ -0,0 +1,63 @@
+// ====================================================================
+//  METRICS
+//  Counters and latency histograms behind /metrics (Prometheus text
+//  format 0.0.4). Every metric is fixed storage updated with relaxed
+//  atomic adds, so the audio and render threads can record on their
+//  hot paths: a counter is one add, a histogram observation is two
+//  (its bucket and its sum). Scrapes read without locking and may catch
+//  a histogram between those two adds, which Prometheus tolerates.
+// ====================================================================
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+class MetricCounter {
+public:
+    void inc(uint64_t n = 1) { v.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return v.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> v{0};
+};
+
+// Durations in microseconds, exported in seconds
+class LatencyHistogram {
+public:
+    static const int BUCKETS = 12;
+    static const float BOUNDS_US[BUCKETS];  // upper bounds; one more bucket is +Inf
+
+    void observe(float us);
+
+    // _bucket, _sum and _count lines. 'labels' is e.g. effect="Plasma" or "".
+    void write(std::string& out, const char* name, const char* labels) const;
+
+private:
+    std::atomic<uint64_t> counts[BUCKETS + 1] = {};  // per bucket, not cumulative
+    std::atomic<uint64_t> sumNs{0};
+};
+
+enum CaptureRecovery { RECOVER_OVERRUN, RECOVER_IO, RECOVER_OTHER, RECOVER_KINDS };
+
+struct Metrics {
+    static const int MAX_EFFECTS = 32;  // ids beyond this are not recorded
+
+    MetricCounter captureRecoveries[RECOVER_KINDS];  // recoverCapture() by error
+    LatencyHistogram analysisUs;                     // one hop: window + FFT + bands + beat
+    LatencyHistogram swapWaitUs;                     // presenter blocked in SwapOnVSync
+    LatencyHistogram effectUs[MAX_EFFECTS];          // one effect's render call
+    MetricCounter effectOverBudget[MAX_EFFECTS];     // render call longer than its budget
+
+    void observeEffect(int id, float us, float budgetUs) {
+        if ((unsigned)id >= (unsigned)MAX_EFFECTS) return;
+        effectUs[id].observe(us);
+        if (us > budgetUs) effectOverBudget[id].inc();
+    }
+};
+
+extern Metrics metrics;
+
+// Text exposition helpers
+void writeMetricHeader(std::string& out, const char* name, const char* type, const char* help);
+void writeMetricValue(std::string& out, const char* name, const char* labels, double value);
@@ -0,0 +1,128 @@
+// ====================================================================
+//  PREVIEW (see preview.h)
+// ====================================================================
+
+#include "preview.h"
+#include "audio_led.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cstring>
+
+static const int PREVIEW_KEYFRAME_SEC = 5;
+
+FrameTap previewTap(WIDTH, HEIGHT);
+
+static std::atomic<int> g_previewClients{0};
+static std::atomic<uint64_t> g_previewBytes{0};
+
+int previewClientCount() { return g_previewClients.load(std::memory_order_relaxed); }
+uint64_t previewBytesSent() { return g_previewBytes.load(std::memory_order_relaxed); }
+
+// ---------------------- Frame tap --------------------------------
+void FrameTap::offer(const FrameBuffer& fb) {
+    if (!wanted.load(std::memory_order_relaxed)) return;
+    if (fb.width() != w || fb.height() != h) return;
+
+    std::unique_lock<std::mutex> lock(mtx, std::try_to_lock);
+    if (!lock.owns_lock()) return;
+    memcpy(snap.data(), fb.data(), snap.size() * sizeof(uint32_t));
+    if (++seqNo == 0) seqNo = 1;
+    wanted.store(false, std::memory_order_relaxed);
+}
+
+bool FrameTap::latest(std::vector<uint32_t>& out, uint32_t& seq) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (seqNo == seq) return false;
+    out.assign(snap.begin(), snap.end());
+    seq = seqNo;
+    return true;
+}
+
+// ---------------------- Encoder ----------------------------------
+static inline void putRGB(std::string& out, uint32_t c) {
+    char rgb[3] = {(char)pixelR(c), (char)pixelG(c), (char)pixelB(c)};
+    out.append(rgb, 3);
+}
+
+void encodePreviewDelta(const uint32_t* cur, uint32_t* prev, size_t n, std::string& out) {
+    size_t i = 0;
+    while (i < n) {
+        // Unchanged pixels; nothing is sent for the tail of the frame
+        size_t j = i;
+        while (j < n && cur[j] == prev[j]) j++;
+        if (j == n) break;
+        while (i < j) {
+            size_t k = std::min<size_t>(64, j - i);
+            out += (char)(k - 1);
+            i += k;
+        }
+
+        // Runs of one colour (they may cover unchanged pixels too)
+        size_t r = i + 1;
+        while (r < n && r - i < 128 && cur[r] == cur[i]) r++;
+        if (r - i >= 2) {
+            out += (char)(0x80 | (r - i - 1));
+            putRGB(out, cur[i]);
+            i = r;
+            continue;
+        }
+
+        // Literals until an unchanged pixel or the start of a run
+        size_t e = i + 1;
+        while (e < n && e - i < 64 && cur[e] != prev[e] && !(e + 1 < n && cur[e + 1] == cur[e])) e++;
+        out += (char)(0x40 | (e - i - 1));
+        for (size_t k = i; k < e; k++) putRGB(out, cur[k]);
+        i = e;
+    }
+    memcpy(prev, cur, n * sizeof(uint32_t));
+}
+
+// ---------------------- Stream -----------------------------------
+PreviewStream* PreviewStream::create(int fps) {
+    if (g_previewClients.fetch_add(1, std::memory_order_relaxed) >= MAX_CLIENTS) {
+        g_previewClients.fetch_sub(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return new PreviewStream(fps);
+}
+
+PreviewStream::PreviewStream(int fps)
+    : interval(1000 / fps), keyEvery(fps * PREVIEW_KEYFRAME_SEC), sinceKey(keyEvery),
+      cur((size_t)previewTap.width() * previewTap.height()), prev(cur.size()) {}
+
+PreviewStream::~PreviewStream() {
+    g_previewClients.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool PreviewStream::next(std::string& out) {
+    // Have the render thread copy a frame for the next tick
+    previewTap.request();
+    if (!previewTap.latest(cur, seq)) return false;
+    TRACE_SCOPE("preview_encode");
+
+    bool key = sinceKey >= keyEvery;
+    if (key) {
+        std::fill(prev.begin(), prev.end(), 0);
+        sinceKey = 0;
+    }
+    sinceKey++;
+
+    size_t start = out.size();
+    int w = previewTap.width(), h = previewTap.height();
+    char head[9] = {0, 0, 0, 0, (char)(key ? 1 : 0),
+                    (char)(w & 0xFF), (char)(w >> 8), (char)(h & 0xFF), (char)(h >> 8)};
+    out.append(head, sizeof(head));
+    encodePreviewDelta(cur.data(), prev.data(), cur.size(), out);
+
+    // Frame identical to the last one sent: nothing to say
+    if (!key && out.size() == start + sizeof(head)) {
+        out.resize(start);
+        return false;
+    }
+
+    uint32_t len = (uint32_t)(out.size() - start - 4);
+    for (int b = 0; b < 4; b++) out[start + b] = (char)(len >> (8 * b));
+    g_previewBytes.fetch_add(out.size() - start, std::memory_order_relaxed);
+    return true;
+}
@@ -0,0 +1,85 @@
+// ====================================================================
+//  PREVIEW
+//  Remote view of the panel for the web interface (/preview).
+//
+//  The render thread offers every finished frame (the same FrameBuffer
+//  it blits to the panel) to the FrameTap, which copies it only when a
+//  preview client has asked for a new one since the last copy. Each
+//  client's PreviewStream encodes the change against the frame that
+//  client already has, at the rate the client picked.
+//
+//  Wire format, one message per frame (little-endian):
+//      u32 length of what follows
+//      u8  flags     bit 0: keyframe, clear to black before applying
+//      u16 width, u16 height
+//      ops until the message ends, pixels in row-major order:
+//        0x00-0x3F  skip n+1 unchanged pixels
+//        0x40-0x7F  n+1 literal pixels follow, 3 bytes RGB each
+//        0x80-0xFF  n+1 pixels of the one RGB colour that follows
+//      Pixels after the last op are unchanged.
+// ====================================================================
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "framebuffer.h"
+#include "http_server.h"
+
+class FrameTap {
+public:
+    FrameTap(int w, int h) : w(w), h(h), snap((size_t)w * h) {}
+
+    // Render thread, once per frame. Never blocks: if a reader holds the
+    // snapshot, the copy waits for the next frame.
+    void offer(const FrameBuffer& fb);
+
+    // Reader side: ask for the next frame to be copied
+    void request() { wanted.store(true, std::memory_order_relaxed); }
+
+    // Copy the snapshot into 'out' if it is newer than 'seq' (and update seq)
+    bool latest(std::vector<uint32_t>& out, uint32_t& seq);
+
+    int width() const { return w; }
+    int height() const { return h; }
+
+private:
+    int w, h;
+    std::mutex mtx;
+    std::vector<uint32_t> snap;
+    uint32_t seqNo = 0;              // 0 = nothing captured yet
+    std::atomic<bool> wanted{false};
+};
+
+extern FrameTap previewTap;
+
+// Append the ops that turn 'prev' into 'cur' (n pixels); prev becomes cur
+void encodePreviewDelta(const uint32_t* cur, uint32_t* prev, size_t n, std::string& out);
+
+// One /preview connection
+class PreviewStream : public HttpStream {
+public:
+    static const int MAX_CLIENTS = 4;
+
+    // nullptr when MAX_CLIENTS streams are already open
+    static PreviewStream* create(int fps);
+    ~PreviewStream();
+
+    const char* contentType() const override { return "application/octet-stream"; }
+    int intervalMs() const override { return interval; }
+    bool next(std::string& out) override;
+
+private:
+    explicit PreviewStream(int fps);
+
+    int interval;
+    int keyEvery;                    // frames between keyframes
+    int sinceKey;
+    uint32_t seq = 0;
+    std::vector<uint32_t> cur, prev; // prev = what the client shows
+};
+
+int previewClientCount();
+uint64_t previewBytesSent();
@@ -0,0 +1,16 @@
+// ====================================================================
+//  RASTER TABLES (see raster.h)
+// ====================================================================
+
+#include "raster.h"
+
+float rasterDistLut[HEIGHT + 1][WIDTH + 1];
+
+// Filled once at startup, before any effect runs
+static struct RasterTableInit {
+    RasterTableInit() {
+        for (int dy = 0; dy <= HEIGHT; dy++)
+            for (int dx = 0; dx <= WIDTH; dx++)
+                rasterDistLut[dy][dx] = sqrtf((float)(dx * dx + dy * dy));
+    }
+} rasterTableInit;
@@ -0,0 +1,169 @@
+// ====================================================================
+//  RASTER
+//  Filled primitives for the effect code. Every primitive walks only
+//  the rows it covers and hands each covered horizontal run to a span
+//  shader, so per-pixel work is limited to the shape itself:
+//
+//      void shade(uint32_t* row, int y, int x0, int x1);  // fill row[x0..x1)
+//
+//  Spans are already clipped to the framebuffer when the shader runs.
+//  Every primitive also takes an optional RowRange so several threads can
+//  draw the same shape, each into its own band of rows (render_pool.h).
+// ====================================================================
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include "audio_led.h"
+#include "framebuffer.h"
+
+// ---------------------- Distance table ---------------------------
+// Euclidean length of (dx, dy) for |dx| <= WIDTH, |dy| <= HEIGHT, so any
+// two on-screen points can be measured without a sqrt per pixel.
+extern float rasterDistLut[HEIGHT + 1][WIDTH + 1];
+
+static inline float rasterDistance(int dx, int dy) {
+    return rasterDistLut[abs(dy)][abs(dx)];
+}
+
+// ---------------------- Row clipping -----------------------------
+// Rows [y0, y1) a primitive may touch; default is the whole frame
+struct RowRange {
+    int y0 = 0;
+    int y1 = 1 << 30;
+    RowRange() {}
+    RowRange(int y0, int y1) : y0(y0), y1(y1) {}
+};
+
+// ---------------------- Spans and rects --------------------------
+template <class Shader>
+inline void rasterSpan(FrameBuffer& fb, int y, int x0, int x1, Shader&& shade, RowRange rows = RowRange()) {
+    if ((unsigned)y >= (unsigned)fb.height() || y < rows.y0 || y >= rows.y1) return;
+    if (x0 < 0) x0 = 0;
+    if (x1 > fb.width()) x1 = fb.width();
+    if (x0 < x1) shade(fb.row(y), y, x0, x1);
+}
+
+// [x0, x1) x [y0, y1)
+template <class Shader>
+inline void rasterRect(FrameBuffer& fb, int x0, int y0, int x1, int y1, Shader&& shade,
+                       RowRange rows = RowRange()) {
+    y0 = std::max(y0, std::max(0, rows.y0));
+    y1 = std::min(y1, std::min(fb.height(), rows.y1));
+    for (int y = y0; y < y1; y++) rasterSpan(fb, y, x0, x1, shade);
+}
+
+// ---------------------- Triangle ---------------------------------
+// floor(a / b) and ceil(a / b) for b > 0
+static inline long rasterFloorDiv(long a, long b) { return a >= 0 ? a / b : -((-a + b - 1) / b); }
+static inline long rasterCeilDiv(long a, long b)  { return a >= 0 ? (a + b - 1) / b : -((-a) / b); }
+
+// Pixels (x, y) where the three edge functions
+//     E(P,Q) = (x - Q.x) * (P.y - Q.y) - (P.x - Q.x) * (y - Q.y)
+// for the edges (0,1), (1,2), (2,0) are all >= 0 or all <= 0, i.e. inside
+// or on the boundary for either winding. Each edge function is linear in
+// x on a scanline, so the covered run is found exactly with integer math.
+template <class Shader>
+void rasterTriangle(FrameBuffer& fb, int x0, int y0, int x1, int y1, int x2, int y2, Shader&& shade,
+                    RowRange rows = RowRange()) {
+    const int px[3] = {x0, x1, x2};
+    const int py[3] = {y0, y1, y2};
+
+    int minX = std::min(x0, std::min(x1, x2)), maxX = std::max(x0, std::max(x1, x2));
+    int minY = std::min(y0, std::min(y1, y2)), maxY = std::max(y0, std::max(y1, y2));
+    minY = std::max(minY, std::max(0, rows.y0));
+    maxY = std::min(maxY, std::min(fb.height(), rows.y1) - 1);
+
+    for (int y = minY; y <= maxY; y++) {
+        // E_i(x) = a[i] * x + c[i] on this row
+        long a[3], c[3];
+        for (int i = 0; i < 3; i++) {
+            int p = i, q = (i + 1) % 3;
+            a[i] = py[p] - py[q];
+            c[i] = -(long)px[q] * a[i] - (long)(px[p] - px[q]) * (y - py[q]);
+        }
+
+        // Run where all E_i >= 0 (sign = 1) and where all E_i <= 0 (sign = -1)
+        long runLo[2], runHi[2];
+        for (int s = 0; s < 2; s++) {
+            long lo = minX, hi = maxX;
+            for (int i = 0; i < 3; i++) {
+                long ai = s == 0 ? a[i] : -a[i];
+                long ci = s == 0 ? c[i] : -c[i];
+                if (ai > 0)      lo = std::max(lo, rasterCeilDiv(-ci, ai));
+                else if (ai < 0) hi = std::min(hi, rasterFloorDiv(ci, -ai));
+                else if (ci < 0) hi = lo - 1;  // constant and negative: empty
+            }
+            runLo[s] = lo;
+            runHi[s] = hi;
+        }
+
+        bool has0 = runLo[0] <= runHi[0], has1 = runLo[1] <= runHi[1];
+        if (has0 && has1 && runLo[1] <= runHi[0] + 1 && runLo[0] <= runHi[1] + 1) {
+            // Touching runs (degenerate triangle): draw once
+            rasterSpan(fb, y, (int)std::min(runLo[0], runLo[1]), (int)std::max(runHi[0], runHi[1]) + 1, shade);
+        } else {
+            if (has0) rasterSpan(fb, y, (int)runLo[0], (int)runHi[0] + 1, shade);
+            if (has1) rasterSpan(fb, y, (int)runLo[1], (int)runHi[1] + 1, shade);
+        }
+    }
+}
+
+// ---------------------- Circles and rings ------------------------
+// Largest d >= 0 with d*d < rem, or -1 if there is none
+static inline int rasterHalfWidth(float rem) {
+    if (rem <= 0) return -1;
+    int d = (int)sqrtf(rem);
+    while (d > 0 && (float)d * d >= rem) d--;
+    while ((float)(d + 1) * (d + 1) < rem) d++;
+    return d;
+}
+
+// Pixels with rInner <= distance to (cx, cy) < rOuter
+template <class Shader>
+void rasterAnnulus(FrameBuffer& fb, int cx, int cy, float rInner, float rOuter, Shader&& shade,
+                   RowRange rows = RowRange()) {
+    if (rOuter <= 0 || rInner >= rOuter) return;
+    float ro2 = rOuter * rOuter;
+    float ri2 = rInner * rInner;
+    int ry = (int)ceilf(rOuter);
+
+    int dyMin = std::max(-ry, std::max(0, rows.y0) - cy);
+    int dyMax = std::min(ry, std::min(fb.height(), rows.y1) - 1 - cy);
+
+    for (int dy = dyMin; dy <= dyMax; dy++) {
+        int y = cy + dy;
+
+        int outer = rasterHalfWidth(ro2 - (float)dy * dy);
+        if (outer < 0) continue;
+        int inner = rInner > 0 ? rasterHalfWidth(ri2 - (float)dy * dy) : -1;  // |dx| <= inner is the hole
+
+        if (inner < 0) {
+            rasterSpan(fb, y, cx - outer, cx + outer + 1, shade);
+        } else {
+            rasterSpan(fb, y, cx - outer, cx - inner, shade);
+            rasterSpan(fb, y, cx + inner + 1, cx + outer + 1, shade);
+        }
+    }
+}
+
+// Pixels with distance to (cx, cy) < radius
+template <class Shader>
+inline void rasterDisc(FrameBuffer& fb, int cx, int cy, float radius, Shader&& shade,
+                       RowRange rows = RowRange()) {
+    rasterAnnulus(fb, cx, cy, 0.0f, radius, shade, rows);
+}
+
+// ---------------------- Diamond ----------------------------------
+// Pixels with |x - cx| + |y - cy| < size
+template <class Shader>
+void rasterDiamond(FrameBuffer& fb, int cx, int cy, int size, Shader&& shade,
+                   RowRange rows = RowRange()) {
+    int dyMin = std::max(-(size - 1), std::max(0, rows.y0) - cy);
+    int dyMax = std::min(size - 1, std::min(fb.height(), rows.y1) - 1 - cy);
+    for (int dy = dyMin; dy <= dyMax; dy++) {
+        int half = size - 1 - abs(dy);
+        rasterSpan(fb, cy + dy, cx - half, cx + half + 1, shade);
+    }
+}
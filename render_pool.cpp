@@ -0,0 +1,100 @@
+// ====================================================================
+//  RENDER POOL (see render_pool.h)
+// ====================================================================
+
+#include "render_pool.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cstdio>
+
+RenderPool* g_renderPool = nullptr;
+
+int defaultRenderThreads() {
+    int cores = (int)std::thread::hardware_concurrency();
+    return std::max(1, std::min(4, cores - 1));
+}
+
+RenderPool::RenderPool(int threads) : slots(std::max(1, threads)) {
+    for (int i = 1; i < (int)slots.size(); i++)
+        workers.emplace_back(&RenderPool::workerLoop, this, i);
+}
+
+RenderPool::~RenderPool() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    startCv.notify_all();
+    for (auto& t : workers) t.join();
+}
+
+void RenderPool::run(int rows, int grain, BandFn fn, void* ctx) {
+    if (grain < 1) grain = 1;
+    int bands = (rows + grain - 1) / grain;
+    int n = (int)slots.size();
+
+    // Contiguous share of the bands for each thread
+    for (int i = 0; i < n; i++) {
+        slots[i].next.store(bands * i / n, std::memory_order_relaxed);
+        slots[i].end = bands * (i + 1) / n;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        jobFn = fn;
+        jobCtx = ctx;
+        jobRows = rows;
+        jobGrain = grain;
+        pending = n - 1;
+        generation++;
+    }
+    startCv.notify_all();
+
+    work(0);
+
+    // Workers may still be finishing a band (and read the job), so wait for all
+    std::unique_lock<std::mutex> lock(mtx);
+    doneCv.wait(lock, [this] { return pending == 0; });
+}
+
+void RenderPool::work(int self) {
+    int n = (int)slots.size();
+    // Own share first, then steal from the others
+    for (int k = 0; k < n; k++) {
+        Slot& s = slots[(self + k) % n];
+        for (;;) {
+            int band = s.next.fetch_add(1, std::memory_order_relaxed);
+            if (band >= s.end) break;
+            int y0 = band * jobGrain;
+            int y1 = std::min(jobRows, y0 + jobGrain);
+            TRACE_SCOPE("band");
+            jobFn(jobCtx, y0, y1);
+        }
+    }
+}
+
+void RenderPool::workerLoop(int index) {
+    char name[24];
+    snprintf(name, sizeof(name), "render pool %d", index);
+    TRACE_THREAD(name);
+
+    unsigned seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            startCv.wait(lock, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+
+        work(index);
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            last = (--pending == 0);
+        }
+        if (last) doneCv.notify_one();
+    }
+}
@@ -0,0 +1,82 @@
+// ====================================================================
+//  RENDER POOL
+//  Persistent worker threads for splitting a frame into row bands.
+//  Threads are created once at startup and sleep between frames.
+//
+//  parallelRows(rows, grain, fn) calls fn(y0, y1) for bands of 'grain'
+//  rows covering [0, rows). Each thread starts on its own contiguous
+//  share of the bands and, when that runs out, steals the remaining
+//  bands of the others, so one slow band does not stall the frame.
+//  The calling thread works too; the call returns when all bands are done.
+// ====================================================================
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class RenderPool {
+public:
+    // threads = total threads working on a frame, including the caller
+    explicit RenderPool(int threads);
+    ~RenderPool();
+
+    RenderPool(const RenderPool&) = delete;
+    RenderPool& operator=(const RenderPool&) = delete;
+
+    int threads() const { return (int)slots.size(); }
+
+    template <class F>
+    void parallelRows(int rows, int grain, F&& fn) {
+        typedef typename std::remove_reference<F>::type Fn;
+        run(rows, grain, [](void* ctx, int y0, int y1) { (*(Fn*)ctx)(y0, y1); }, (void*)&fn);
+    }
+
+private:
+    typedef void (*BandFn)(void* ctx, int y0, int y1);
+
+    // Band range owned by one thread; others steal from it via 'next'
+    struct alignas(64) Slot {
+        std::atomic<int> next{0};
+        int end = 0;
+    };
+
+    void run(int rows, int grain, BandFn fn, void* ctx);
+    void work(int self);
+    void workerLoop(int index);
+
+    std::vector<Slot> slots;
+    std::vector<std::thread> workers;
+
+    // Current job
+    BandFn jobFn = nullptr;
+    void* jobCtx = nullptr;
+    int jobRows = 0;
+    int jobGrain = 1;
+
+    std::mutex mtx;
+    std::condition_variable startCv, doneCv;
+    unsigned generation = 0;   // bumped for every job
+    int pending = 0;           // workers still busy with the current job
+    bool stopping = false;
+};
+
+// Pool used by the effects; nullptr (or 1 thread) renders inline
+extern RenderPool* g_renderPool;
+
+// Default worker count: all cores but one (left for the matrix refresh
+// thread), at least 1, at most 4
+int defaultRenderThreads();
+
+// Run fn(y0, y1) over [0, rows) on g_renderPool, or inline without one.
+// 'grain' rows per band; small bands balance better, big ones cost less.
+template <class F>
+inline void parallelRows(int rows, int grain, F&& fn) {
+    if (g_renderPool && g_renderPool->threads() > 1)
+        g_renderPool->parallelRows(rows, grain, fn);
+    else
+        fn(0, rows);
+}
@@ -0,0 +1,122 @@
+// ====================================================================
+//  RENDER SCALE (see scaler.h)
+// ====================================================================
+
+#include "scaler.h"
+#include "audio_led.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+static void upscaleNearest(const FrameBuffer& src, FrameBuffer& dst, int f) {
+    for (int y = 0; y < dst.height(); y++) {
+        const uint32_t* in = src.row(y / f);
+        uint32_t* out = dst.row(y);
+        for (int x = 0; x < src.width(); x++)
+            for (int i = 0; i < f; i++) *out++ = in[x];
+    }
+}
+
+// Source pixel centers sit at (s + 0.5) * f - 0.5 in the destination.
+// For each destination coordinate: left/top source index and the 8-bit
+// weight of the next one, clamped at the edges.
+static void bilinearTaps(int srcLen, int f, int* idx, uint32_t* weight) {
+    for (int d = 0; d < srcLen * f; d++) {
+        int pos = (2 * d + 1) * 128 / f - 128;  // source position in 1/256 px
+        if (pos < 0) pos = 0;
+        int i = pos >> 8;
+        if (i >= srcLen - 1) {
+            idx[d] = srcLen - 1;
+            weight[d] = 0;
+        } else {
+            idx[d] = i;
+            weight[d] = pos & 255;
+        }
+    }
+}
+
+static void upscaleBilinear(const FrameBuffer& src, FrameBuffer& dst, int f) {
+    const int sw = src.width(), sh = src.height();
+    int xIdx[WIDTH], yIdx[HEIGHT];
+    uint32_t xW[WIDTH], yW[HEIGHT];
+    bilinearTaps(sw, f, xIdx, xW);
+    bilinearTaps(sh, f, yIdx, yW);
+
+    uint32_t tmp[WIDTH + 1];
+    for (int y = 0; y < dst.height(); y++) {
+        // Vertical blend of the two source rows, then horizontal
+        const uint32_t* r0 = src.row(yIdx[y]);
+        const uint32_t* r1 = src.row(yW[y] ? yIdx[y] + 1 : yIdx[y]);
+        for (int x = 0; x < sw; x++) tmp[x] = mixPixel(r0[x], r1[x], yW[y]);
+        tmp[sw] = tmp[sw - 1];  // right edge tap (weight is 0 there)
+
+        uint32_t* out = dst.row(y);
+        for (int x = 0; x < dst.width(); x++)
+            out[x] = mixPixel(tmp[xIdx[x]], tmp[xIdx[x] + 1], xW[x]);
+    }
+}
+
+void upscaleFrame(const FrameBuffer& src, FrameBuffer& dst, int filter) {
+    int f = dst.width() / src.width();
+    if (f <= 1) {
+        memcpy(dst.data(), src.data(), dst.pixelCount() * sizeof(uint32_t));
+    } else if (filter == UPSCALE_BILINEAR) {
+        upscaleBilinear(src, dst, f);
+    } else {
+        upscaleNearest(src, dst, f);
+    }
+}
+
+// Step down after this many frames over HIGH_WATER of the budget, back up
+// after this many frames where the finer scale would stay under LOW_WATER
+static const int STEP_DOWN_FRAMES = 8;
+static const int STEP_UP_FRAMES = 120;
+static const float HIGH_WATER = 0.75f;
+static const float LOW_WATER = 0.5f;
+
+void RenderScaleController::report(int id, int scale, float renderUs, float budgetUs) {
+    State& s = state[id];
+    if (scale != s.scale) return;  // not rendered at the controller's scale
+    s.avgUs = s.avgUs == 0 ? renderUs : s.avgUs + (renderUs - s.avgUs) / 8.0f;
+
+    if (s.avgUs > HIGH_WATER * budgetUs && s.scale < 4) {
+        s.streak = std::min(s.streak, 0) - 1;
+        if (s.streak <= -STEP_DOWN_FRAMES) {
+            s.scale *= 2;
+            s.avgUs /= 4;  // estimate until measured
+            s.streak = 0;
+        }
+    } else if (s.scale > 1 && s.avgUs * 4 < LOW_WATER * budgetUs) {
+        s.streak = std::max(s.streak, 0) + 1;
+        if (s.streak >= STEP_UP_FRAMES) {
+            s.scale /= 2;
+            s.avgUs *= 4;
+            s.streak = 0;
+        }
+    } else {
+        s.streak = 0;
+    }
+}
+
+ScaledRenderer::ScaledRenderer() : half(WIDTH / 2, HEIGHT / 2), quarter(WIDTH / 4, HEIGHT / 4) {}
+
+int ScaledRenderer::render(int id, FrameBuffer& out, float t, int br, float budgetUs) {
+    if (!effectScalable(id)) {
+        renderEffect(id, out, t, br);
+        return 1;
+    }
+
+    int fixedScale = settings.renderScale.load();
+    int scale = fixedScale > 0 ? fixedScale : controller.scaleFor(id);
+    FrameBuffer& target = scale >= 4 ? quarter : scale == 2 ? half : out;
+
+    auto start = std::chrono::steady_clock::now();
+    renderEffect(id, target, t, br);
+    if (&target != &out) upscaleFrame(target, out, settings.upscaleFilter.load());
+    auto end = std::chrono::steady_clock::now();
+
+    if (fixedScale <= 0)
+        controller.report(id, scale, std::chrono::duration<float, std::micro>(end - start).count(), budgetUs);
+    return scale;
+}
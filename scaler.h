@@ -0,0 +1,53 @@
+// ====================================================================
+//  RENDER SCALE
+//  Heavy effects can be drawn at half or quarter resolution (see
+//  effectScalable) and upscaled to the full frame. The controller picks
+//  the scale per effect from its measured render time: it steps down
+//  when a frame keeps using most of the budget and back up once the
+//  finer scale (about 4x the pixels) would fit comfortably.
+// ====================================================================
+#pragma once
+
+#include "effects.h"
+#include "framebuffer.h"
+
+#include <vector>
+
+enum UpscaleFilter { UPSCALE_NEAREST = 0, UPSCALE_BILINEAR = 1 };
+
+// Upscale src into dst by an integer factor (dst size / src size: 2 or 4)
+void upscaleFrame(const FrameBuffer& src, FrameBuffer& dst, int filter);
+
+class RenderScaleController {
+public:
+    // Scale divisor (1, 2 or 4) for the next frame of effect 'id'
+    int scaleFor(int id) const { return state[id].scale; }
+
+    // Time spent on a frame of effect 'id' at 'scale' (render + upscale)
+    // and the time allowed per frame
+    void report(int id, int scale, float renderUs, float budgetUs);
+
+private:
+    struct State {
+        int scale = 1;
+        float avgUs = 0;     // smoothed render time at 'scale'
+        int streak = 0;      // >0: frames with headroom, <0: frames over budget
+    };
+    std::vector<State> state = std::vector<State>(effectCount());
+};
+
+// Draws an effect into a full-size frame; scalable effects go through a
+// half or quarter size buffer (settings.renderScale, or the controller in
+// auto mode) and are upscaled with settings.upscaleFilter
+class ScaledRenderer {
+public:
+    ScaledRenderer();
+
+    // Render effect 'id' into 'out' (WIDTH x HEIGHT); returns the scale used.
+    // budgetUs is the time allowed for this effect per frame.
+    int render(int id, FrameBuffer& out, float t, int br, float budgetUs);
+
+private:
+    FrameBuffer half, quarter;
+    RenderScaleController controller;
+};
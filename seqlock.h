@@ -0,0 +1,57 @@
+// ====================================================================
+//  SEQLOCK
+//  Single-writer, multi-reader publication of a small POD value.
+//  The writer never waits; readers retry only if they raced a write.
+// ====================================================================
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock needs a trivially copyable type");
+
+public:
+    SeqLock() {
+        T zero{};
+        store(zero);
+    }
+
+    // Publish a new value. Only one thread may call this.
+    void store(const T& value) {
+        uint32_t words[WORDS] = {0};
+        memcpy(words, &value, sizeof(T));
+
+        uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);          // odd = write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < WORDS; i++)
+            data[i].store(words[i], std::memory_order_relaxed);
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    // Consistent copy of the last published value
+    T load() const {
+        uint32_t words[WORDS];
+        uint32_t s0, s1;
+        do {
+            s0 = seq.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORDS; i++)
+                words[i] = data[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            s1 = seq.load(std::memory_order_relaxed);
+        } while ((s0 & 1) || s0 != s1);
+
+        T value;
+        memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+    std::atomic<uint32_t> seq{0};
+    std::atomic<uint32_t> data[WORDS];
+};
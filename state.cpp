@@ -0,0 +1,15 @@
+// ====================================================================
+//  SHARED STATE DEFINITIONS (declared in audio_led.h)
+// ====================================================================
+#include "audio_led.h"
+
+Settings settings;
+
+std::atomic<float> g_deltaTime{0.016f};
+std::atomic<float> g_rawDeltaTime{0.016f};
+
+AudioState audio;
+AudioFrame g_audio;
+
+CaptureInfo capture;
+PipelineInfo pipeline;
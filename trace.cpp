@@ -0,0 +1,130 @@
+// ====================================================================
+//  TRACE (see trace.h)
+// ====================================================================
+
+#include "trace.h"
+
+#ifdef TRACE_ENABLED
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <unistd.h>
+
+static const int TRACE_MAX_THREADS = 32;
+static const uint64_t TRACE_RING_EVENTS = 16384;  // per thread, power of two
+
+// One complete event. seq is 2*index+1 while the owner writes the slot
+// and 2*index+2 once it is complete, so a reader can tell a finished
+// event from one being overwritten.
+struct TraceSlot {
+    std::atomic<uint64_t> seq{0};
+    std::atomic<const char*> name{nullptr};
+    std::atomic<int64_t> startNs{0};
+    std::atomic<int64_t> endNs{0};
+};
+
+struct TraceRing {
+    char threadName[32];
+    int tid;
+    std::atomic<uint64_t> head{0};  // events written; only the owning thread stores
+    TraceSlot slots[TRACE_RING_EVENTS];
+};
+
+static std::mutex g_traceMtx;  // ring registration only
+static TraceRing* g_rings[TRACE_MAX_THREADS];
+static std::atomic<int> g_ringCount{0};
+
+static thread_local TraceRing* t_ring = nullptr;
+static thread_local bool t_ringTried = false;
+
+// The calling thread's ring, created on its first event
+static TraceRing* threadRing() {
+    if (t_ring || t_ringTried) return t_ring;
+    t_ringTried = true;
+
+    std::lock_guard<std::mutex> lock(g_traceMtx);
+    int n = g_ringCount.load(std::memory_order_relaxed);
+    if (n >= TRACE_MAX_THREADS) return nullptr;
+    TraceRing* r = new TraceRing();
+    r->tid = n + 1;
+    snprintf(r->threadName, sizeof(r->threadName), "thread %d", n + 1);
+    g_rings[n] = r;
+    g_ringCount.store(n + 1, std::memory_order_release);
+    t_ring = r;
+    return r;
+}
+
+int64_t traceNowNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void traceRecord(const char* name, int64_t startNs, int64_t endNs) {
+    TraceRing* r = threadRing();
+    if (!r) return;
+
+    uint64_t i = r->head.load(std::memory_order_relaxed);
+    TraceSlot& s = r->slots[i & (TRACE_RING_EVENTS - 1)];
+    s.seq.store(2 * i + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    s.name.store(name, std::memory_order_relaxed);
+    s.startNs.store(startNs, std::memory_order_relaxed);
+    s.endNs.store(endNs, std::memory_order_relaxed);
+    s.seq.store(2 * i + 2, std::memory_order_release);
+    r->head.store(i + 1, std::memory_order_release);
+}
+
+// Call once at thread start, before the thread's first event
+void traceSetThreadName(const char* name) {
+    TraceRing* r = threadRing();
+    if (r) snprintf(r->threadName, sizeof(r->threadName), "%s", name);
+}
+
+bool traceExport(double seconds, std::string& out) {
+    int64_t cutoff = traceNowNs() - (int64_t)(seconds * 1e9);
+    int pid = (int)getpid();
+    char line[256];
+
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    int rings = g_ringCount.load(std::memory_order_acquire);
+    for (int t = 0; t < rings; t++) {
+        TraceRing* r = g_rings[t];
+        snprintf(line, sizeof(line), "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                 first ? "" : ",\n", pid, r->tid, r->threadName);
+        out += line;
+        first = false;
+
+        uint64_t head = r->head.load(std::memory_order_acquire);
+        uint64_t oldest = head > TRACE_RING_EVENTS ? head - TRACE_RING_EVENTS : 0;
+        for (uint64_t i = oldest; i < head; i++) {
+            TraceSlot& s = r->slots[i & (TRACE_RING_EVENTS - 1)];
+            uint64_t s1 = s.seq.load(std::memory_order_acquire);
+            const char* name = s.name.load(std::memory_order_relaxed);
+            int64_t startNs = s.startNs.load(std::memory_order_relaxed);
+            int64_t endNs = s.endNs.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t s2 = s.seq.load(std::memory_order_relaxed);
+
+            // Overwritten by a newer event while we read it: drop
+            if (s1 != 2 * i + 2 || s2 != s1 || !name) continue;
+            if (endNs < cutoff) continue;
+
+            snprintf(line, sizeof(line), ",\n{\"ph\":\"X\",\"name\":\"%s\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                     name, pid, r->tid, startNs / 1000.0, (endNs - startNs) / 1000.0);
+            out += line;
+        }
+    }
+    out += "]}\n";
+    return true;
+}
+
+#else
+
+bool traceExport(double, std::string&) { return false; }
+
+#endif
@@ -0,0 +1,57 @@
+// ====================================================================
+//  TRACE
+//  Scoped timing markers for finding where a stutter comes from:
+//
+//      TRACE_SCOPE("fft");        // records [here, end of scope)
+//      TRACE_THREAD("audio");     // names the calling thread in the trace
+//
+//  Built only with make TRACE=1 (-DTRACE_ENABLED); otherwise both macros
+//  expand to nothing and their arguments are not evaluated.
+//
+//  Each thread writes complete events into its own fixed ring (the
+//  newest TRACE_RING_EVENTS are kept) with relaxed stores and a
+//  per-slot sequence number, so recording never locks or allocates
+//  after the thread's first event. traceExport() reads every ring and
+//  writes the last N seconds as Chrome trace JSON (chrome://tracing,
+//  ui.perfetto.dev). Names must be string literals or otherwise live
+//  for the whole run.
+// ====================================================================
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#ifdef TRACE_ENABLED
+
+int64_t traceNowNs();
+void traceRecord(const char* name, int64_t startNs, int64_t endNs);
+void traceSetThreadName(const char* name);
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : name(name), startNs(traceNowNs()) {}
+    ~TraceScope() { traceRecord(name, startNs, traceNowNs()); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    int64_t startNs;
+};
+
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
+#define TRACE_THREAD(name) traceSetThreadName(name)
+
+#else
+
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_THREAD(name) ((void)0)
+
+#endif
+
+// Chrome trace JSON of the events that ended in the last 'seconds'.
+// Returns false (and leaves 'out' alone) when tracing is compiled out.
+bool traceExport(double seconds, std::string& out);
@@ -0,0 +1,131 @@
+// ====================================================================
+//  TRANSITIONS (see transition.h)
+// ====================================================================
+
+#include "transition.h"
+#include "audio_led.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if !defined(DSP_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define BLEND_NEON 1
+#elif !defined(DSP_NO_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#define BLEND_SSE2 1
+#endif
+
+const char* blend_variant() {
+#if defined(BLEND_NEON)
+    return "neon";
+#elif defined(BLEND_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+// ---------------------- Alpha blend ------------------------------
+// Channels are widened to 16 bits: 255 * 256 still fits, so
+// a * (256 - alpha) + b * alpha never overflows.
+void blendPixels(uint32_t* dst, const uint32_t* a, const uint32_t* b, int n, int alpha) {
+    int i = 0;
+#if defined(BLEND_NEON)
+    const uint16x8_t wa = vdupq_n_u16((uint16_t)(256 - alpha));
+    const uint16x8_t wb = vdupq_n_u16((uint16_t)alpha);
+    for (; i + 4 <= n; i += 4) {
+        uint8x16_t va = vld1q_u8((const uint8_t*)(a + i));
+        uint8x16_t vb = vld1q_u8((const uint8_t*)(b + i));
+        uint16x8_t lo = vmlaq_u16(vmulq_u16(vmovl_u8(vget_low_u8(va)), wa), vmovl_u8(vget_low_u8(vb)), wb);
+        uint16x8_t hi = vmlaq_u16(vmulq_u16(vmovl_u8(vget_high_u8(va)), wa), vmovl_u8(vget_high_u8(vb)), wb);
+        vst1q_u8((uint8_t*)(dst + i), vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+    }
+#elif defined(BLEND_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i wa = _mm_set1_epi16((short)(256 - alpha));
+    const __m128i wb = _mm_set1_epi16((short)alpha);
+    for (; i + 4 <= n; i += 4) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        // 16-bit products wrap as unsigned; the sum is at most 255 * 256
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), wa),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), wb));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), wa),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), wb));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+    }
+#endif
+    for (; i < n; i++)
+        dst[i] = mixPixel(a[i], b[i], (uint32_t)alpha);
+}
+
+// ---------------------- Wipe -------------------------------------
+static const int WIPE_EDGE = 8;  // soft edge width in pixels
+
+// Weight of the incoming frame at distance c from the side the wipe
+// starts on, with the leading edge at 'pos'
+static inline int wipeAlpha(int c, int pos) {
+    return std::max(0, std::min(256, (pos - c) * 256 / WIPE_EDGE));
+}
+
+static void wipeFrames(FrameBuffer& dst, const FrameBuffer& out, const FrameBuffer& in,
+                       int direction, float progress) {
+    const int w = dst.width(), h = dst.height();
+    const bool vertical = direction >= 2;
+    const int pos = (int)(progress * ((vertical ? h : w) + WIPE_EDGE));
+
+    if (vertical) {
+        // One alpha per row: copy or blend whole rows
+        for (int y = 0; y < h; y++) {
+            int alpha = wipeAlpha(direction == 2 ? y : h - 1 - y, pos);
+            blendPixels(dst.row(y), out.row(y), in.row(y), w, alpha);
+        }
+    } else {
+        // Per row: a span fully showing 'in', the soft edge, then a span
+        // fully showing 'out' (mirrored for right-to-left). Only the edge,
+        // under WIPE_EDGE pixels, is mixed per pixel.
+        const int inN = std::max(0, std::min(w, pos - WIPE_EDGE + 1));
+        const int edgeEnd = std::max(0, std::min(w, pos));
+        const int inX = direction == 0 ? 0 : w - inN;
+        const int outX = direction == 0 ? edgeEnd : 0;
+        const int outN = w - edgeEnd;
+        const int edgeX = direction == 0 ? inN : w - edgeEnd;
+        const int edgeN = edgeEnd - inN;
+        for (int y = 0; y < h; y++) {
+            const uint32_t* a = out.row(y);
+            const uint32_t* b = in.row(y);
+            uint32_t* d = dst.row(y);
+            // dst may alias 'in' (see transition.h): then the span is already there
+            if (d != b) memcpy(d + inX, b + inX, inN * sizeof(uint32_t));
+            memcpy(d + outX, a + outX, outN * sizeof(uint32_t));
+            for (int x = edgeX; x < edgeX + edgeN; x++)
+                d[x] = mixPixel(a[x], b[x], (uint32_t)wipeAlpha(direction == 0 ? x : w - 1 - x, pos));
+        }
+    }
+}
+
+// ---------------------- Transition -------------------------------
+void Transition::start(int fromEffect, int transitionType, float durationSec) {
+    if (transitionType == TRANSITION_CUT || durationSec <= 0) {
+        stop();
+        return;
+    }
+    if (transitionType == TRANSITION_WIPE) direction = wipeCount++ % 4;
+    from = fromEffect;
+    type = transitionType;
+    duration = durationSec;
+    elapsed = 0;
+}
+
+void Transition::compose(FrameBuffer& dst, const FrameBuffer& out, const FrameBuffer& in, float dt) {
+    float progress = std::min(1.0f, elapsed / duration);
+    if (type == TRANSITION_WIPE) {
+        wipeFrames(dst, out, in, direction, progress);
+    } else {
+        blendPixels(dst.data(), out.data(), in.data(), (int)dst.pixelCount(), (int)(progress * 256));
+    }
+
+    elapsed += dt;
+    if (elapsed >= duration) stop();
+}
@@ -0,0 +1,48 @@
+// ====================================================================
+//  TRANSITIONS
+//  Crossfade and wipe between the outgoing and incoming effect. Both are
+//  rendered into full-size frames and combined in one pass:
+//    - crossfade: every pixel mixed with one alpha, vectorized per
+//      platform like the DSP kernels (NEON, SSE2, packed-integer scalar)
+//    - wipe: the incoming frame slides in from one side with a soft edge,
+//      the direction changing with every transition
+// ====================================================================
+#pragma once
+
+#include <cstdint>
+#include "framebuffer.h"
+
+enum TransitionType { TRANSITION_CUT = 0, TRANSITION_FADE = 1, TRANSITION_WIPE = 2 };
+
+// Name of the compiled-in blend kernel ("neon", "sse2" or "scalar")
+const char* blend_variant();
+
+// dst[i] = (a[i] * (256 - alpha) + b[i] * alpha) / 256 per channel,
+// alpha = 0..256; dst may alias a or b
+void blendPixels(uint32_t* dst, const uint32_t* a, const uint32_t* b, int n, int alpha);
+
+class Transition {
+public:
+    // Begin a transition away from effect 'from'
+    void start(int from, int type, float durationSec);
+
+    // Stop at once (the incoming effect is shown alone)
+    void stop() { from = -1; }
+
+    bool active() const { return from >= 0; }
+
+    // Effect being faded out (valid while active)
+    int source() const { return from; }
+
+    // Combine the outgoing frame 'out' with the incoming frame 'in' into
+    // dst (may alias 'in') and advance by dt seconds; ends when complete
+    void compose(FrameBuffer& dst, const FrameBuffer& out, const FrameBuffer& in, float dt);
+
+private:
+    int from = -1;
+    int type = TRANSITION_FADE;
+    int direction = 0;      // wipe: 0=left-right, 1=right-left, 2=top-bottom, 3=bottom-top
+    int wipeCount = 0;      // wipes so far, picks the next direction
+    float duration = 1;
+    float elapsed = 0;
+};